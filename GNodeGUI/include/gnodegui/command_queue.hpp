@@ -0,0 +1,138 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file command_queue.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Lock-free queue of viewer commands, pushed from any thread and applied on
+ * the GUI thread (see GraphViewer::push_command).
+ *
+ * Compute workers report the node status through this queue instead of queued slot
+ * invocations: no allocation nor lock per command, and the GUI thread applies them
+ * in batches once per frame.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "gnodegui/graph_records.hpp"
+
+namespace gngui
+{
+
+enum ViewerCommandType
+{
+  COMPUTE_FINISHED, // same as GraphViewer::on_compute_finished
+  COMPUTE_STARTED,  // same as GraphViewer::on_compute_started
+  COMPUTE_STATE,    // same as GraphViewer::set_compute_state, for a single node
+  UPDATE_FINISHED,  // same as GraphViewer::on_update_finished, no node
+  UPDATE_STARTED,   // same as GraphViewer::on_update_started, no node
+};
+
+struct ViewerCommand
+{
+  ViewerCommandType type;
+  NodeHandle        handle = NULL_NODE_HANDLE;
+  ComputeState      state = ComputeState::IDLE; // COMPUTE_STATE only
+  int64_t           time = 0;      // get_time_ns when it happened, 0 for apply time
+  uint32_t          thread_id = 0; // host worker, shown by the compute timeline
+};
+
+/**
+ * Bounded multi-producer queue (D. Vyukov's array based queue): producers only
+ * contend on an atomic counter, each cell carries a sequence number telling whether
+ * it is free or filled. Capacity is fixed at construction, pushing to a full queue
+ * fails. A single consumer is assumed.
+ */
+template <typename T> class CommandQueue
+{
+public:
+  // 'capacity' is rounded up to a power of two
+  explicit CommandQueue(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+
+    this->cells = std::make_unique<Cell[]>(size);
+    this->mask = size - 1;
+
+    for (size_t k = 0; k < size; k++)
+      this->cells[k].sequence.store(k, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return this->mask + 1; }
+
+  // consumer thread only
+  bool try_pop(T &value)
+  {
+    const size_t pos = this->dequeue_pos.load(std::memory_order_relaxed);
+    Cell        &cell = this->cells[pos & this->mask];
+
+    // filled once its sequence is one ahead of the position
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+
+    value = cell.value;
+    cell.sequence.store(pos + this->mask + 1, std::memory_order_release);
+    this->dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+
+    return true;
+  }
+
+  // any thread, false if the queue is full: the value is not stored, the caller has
+  // to retry or keep it elsewhere (see GraphViewer::push_command)
+  bool try_push(const T &value)
+  {
+    size_t pos = this->enqueue_pos.load(std::memory_order_relaxed);
+    Cell  *p_cell;
+
+    for (;;)
+    {
+      p_cell = &this->cells[pos & this->mask];
+
+      const size_t   seq = p_cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+      if (diff == 0)
+      {
+        // free cell, claimed if no other producer got it first
+        if (this->enqueue_pos.compare_exchange_weak(pos,
+                                                    pos + 1,
+                                                    std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // full, the consumer has not freed this cell yet
+      else
+        pos = this->enqueue_pos.load(std::memory_order_relaxed);
+    }
+
+    p_cell->value = value;
+    p_cell->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T                   value;
+  };
+
+  std::unique_ptr<Cell[]> cells;
+  size_t                  mask;
+
+  // on separate cache lines, written by the producers and the consumer
+  alignas(64) std::atomic<size_t> enqueue_pos = 0;
+  alignas(64) std::atomic<size_t> dequeue_pos = 0;
+};
+
+} // namespace gngui
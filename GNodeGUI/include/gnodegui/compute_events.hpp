@@ -0,0 +1,52 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file compute_events.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Timestamped compute start and end events kept by the viewer, in a ring
+ * buffer of fixed capacity (oldest events are overwritten), see ComputeTimeline.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "gnodegui/graph_records.hpp"
+
+namespace gngui
+{
+
+struct ComputeEvent
+{
+  int64_t      time;      // steady clock, in nanoseconds (see get_time_ns)
+  NodeHandle   handle;    // node
+  uint32_t     thread_id; // host thread, 0 if not reported
+  ComputeState state;     // RUNNING for a start, the final state for an end
+};
+
+class ComputeEventLog
+{
+public:
+  explicit ComputeEventLog(size_t capacity);
+
+  // oldest first, 'index' in [0, size())
+  const ComputeEvent &at(size_t index) const;
+  size_t              capacity() const { return this->events.size(); }
+  void                clear();
+  void                push(const ComputeEvent &event);
+  size_t              size() const;
+
+  // number of events ever pushed, tells whether the log changed
+  uint64_t get_revision() const { return this->count; }
+
+private:
+  std::vector<ComputeEvent> events;
+  uint64_t                  count = 0;
+  uint64_t                  count_at_clear = 0;
+};
+
+} // namespace gngui
@@ -0,0 +1,113 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file compute_timeline.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Gantt chart of the node computes of a GraphViewer, built from its compute
+ * events (see GraphViewer::get_compute_events).
+ *
+ * Each run is drawn as a span in the lane of the host thread reporting it. Runs
+ * without thread id are packed in as many lanes as needed for them not to overlap.
+ * The strip above the lanes shows the number of nodes running over time. Clicking
+ * a span selects its node in the viewer.
+ *
+ * Drawing is limited to the visible spans, found by binary search, and the spans
+ * narrower than a pixel are merged, to keep up with hundreds of thousands of events.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+
+#include "gnodegui/graph_viewer.hpp"
+
+namespace gngui
+{
+
+class ComputeTimeline : public QWidget
+{
+  Q_OBJECT
+
+public:
+  explicit ComputeTimeline(GraphViewer *p_viewer, QWidget *parent = nullptr);
+
+  void fit(); // whole time range in view
+
+  // spans rebuilt from the event log if it has changed, also done periodically (see
+  // Style::Timeline::refresh_interval)
+  void refresh();
+
+protected:
+  // --- Qt methods override
+
+  bool event(QEvent *event) override; // tooltips
+  void mouseDoubleClickEvent(QMouseEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void mouseReleaseEvent(QMouseEvent *event) override;
+  void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
+  void wheelEvent(QWheelEvent *event) override;
+
+private:
+  struct Span
+  {
+    int64_t      t0;
+    int64_t      t1; // last event time for runs not finished yet
+    NodeHandle   handle;
+    ComputeState state; // RUNNING if not finished yet
+  };
+
+  struct Lane
+  {
+    QString           caption;
+    std::vector<Span> spans;            // sorted by start time
+    int64_t           max_duration = 0; // bounds the backward search of visible spans
+  };
+
+  void        draw_axis(QPainter &painter);
+  void        draw_concurrency(QPainter &painter);
+  void        draw_lanes(QPainter &painter);
+  int         get_axis_height() const;
+  int         get_lanes_top() const; // scrolling included
+  int         get_max_scroll() const;
+  const Span *get_span_at(QPoint pos) const;
+  double      get_x(int64_t time) const;
+  int64_t     get_time(double x) const;
+  void        rebuild();
+  void        zoom(double factor, double anchor_x);
+
+  // --- Members
+
+  QPointer<GraphViewer> p_viewer;
+  QTimer                refresh_timer;
+  uint64_t              revision = UINT64_MAX; // of the event log, when rebuilt
+
+  std::vector<Lane>                    lanes;
+  std::vector<std::pair<int64_t, int>> concurrency; // (time, running nodes) steps
+  int                                  max_concurrency = 0;
+  int64_t                              time_min = 0;
+  int64_t                              time_max = 0;
+
+  // view
+  double     time_origin = 0.0;  // at the left of the lanes, relative to 'time_min'
+  double     ns_per_pixel = 1e6; // time scale
+  int        scroll_y = 0;       // lanes vertical scrolling
+  bool       is_fitted = true;   // follows the time range as events arrive
+  NodeHandle selected_handle = NULL_NODE_HANDLE;
+
+  // mouse panning
+  QPoint drag_pos;
+  bool   is_dragging = false;
+  bool   has_dragged = false;
+};
+
+} // namespace gngui
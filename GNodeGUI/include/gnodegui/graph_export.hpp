@@ -0,0 +1,59 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file graph_export.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Streaming writers for the structured graph exports (Graphviz DOT, GraphML,
+ * JSON Lines).
+ *
+ * Nodes and links are written one at a time as they are handed over, nothing is
+ * accumulated: memory use does not depend on the graph size. Writers only output
+ * text to a stream, buffering is left to the stream (see GraphViewer::export_graph).
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <QPointF>
+
+#include "gnodegui/graph_records.hpp"
+
+namespace gngui
+{
+
+enum GraphExportFormat
+{
+  DOT,     // Graphviz, with node positions ('neato -n' keeps them)
+  GRAPHML, // XML, ports with their type and data type
+  JSONL,   // newline-delimited JSON, one record per line
+};
+
+// format from a file extension (dot/gv, graphml, jsonl/ndjson), DOT by default
+GraphExportFormat graph_export_format_from_fname(const std::string &fname);
+
+class GraphWriter
+{
+public:
+  explicit GraphWriter(std::ostream &out) : out(out) {}
+  virtual ~GraphWriter() = default;
+
+  // calls order: begin, all the nodes, all the links, end
+  virtual void begin(const std::string &graph_id) = 0;
+  virtual void write_node(const NodeRecord &record, QPointF pos) = 0;
+  virtual void write_link(const LinkRecord &record) = 0;
+  virtual void end() = 0;
+
+protected:
+  std::ostream &out;
+};
+
+std::unique_ptr<GraphWriter> make_graph_writer(GraphExportFormat format,
+                                               std::ostream     &out);
+
+} // namespace gngui
@@ -0,0 +1,354 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file graph_records.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Lightweight node and link records kept by the GraphScene for the whole
+ * graph, whether or not the corresponding graphics items exist.
+ *
+ * With item virtualization, `GraphicsNode` and `GraphicsLink` instances are only
+ * created for the records inside (or near) the viewport. The records hold the state
+ * that must survive an item being released and created again later on.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QPointer>
+#include <QRectF>
+#include <QSize>
+#include <QWidget>
+
+#include "nlohmann/json.hpp"
+
+#include "gnodegui/graphics_link.hpp"
+#include "gnodegui/node_proxy.hpp"
+#include "gnodegui/node_telemetry.hpp"
+
+namespace gngui
+{
+
+class GraphicsLink; // forward decl
+class GraphicsNode; // forward decl
+struct LinkRecord;  // forward decl
+
+// integer counterpart of a node id, for the frequent host calls (compute status,
+// selection...). Never reused within a scene, 0 is not a valid handle. Ports are
+// identified by their index
+using NodeHandle = uint32_t;
+
+constexpr NodeHandle NULL_NODE_HANDLE = 0;
+
+struct NodeRecord
+{
+  std::string               id;
+  NodeHandle                handle = NULL_NODE_HANDLE; // none for summary nodes
+  QPointer<NodeProxy>       p_proxy;
+  QPointF                   pos;
+  QSizeF                    size;
+  std::vector<LinkRecord *> links;
+  GraphicsNode             *p_node = nullptr; // graphics item, if materialized
+
+  // state restored when the item is materialized again
+  bool                       is_selected = false;
+  bool                       is_pinned = false;
+  ComputeState               compute_state = ComputeState::IDLE;
+  bool                       is_widget_visible = true;
+  uint64_t                   data_version = 0;
+  std::function<QWidget *()> widget_factory;
+  QSizeF                     widget_size;
+
+  NodeTelemetry telemetry; // items only refer to it
+
+  // collapsed groups: member nodes are hidden behind the group summary
+  // node, which is not part of the graph (no host counterpart)
+  NodeRecord *p_summary = nullptr; // set for hidden member nodes
+  bool        is_summary = false;
+
+  int            get_port_index(const std::string &port_id) const;
+  void           json_from(const nlohmann::json &json); // same format as GraphicsNode
+  nlohmann::json json_to() const;
+  QRectF         rect() const { return QRectF(this->pos, this->size); }
+};
+
+struct LinkRecord
+{
+  NodeRecord   *node_out = nullptr;
+  int           port_out = -1;
+  NodeRecord   *node_in = nullptr;
+  int           port_in = -1;
+  GraphicsLink *p_link = nullptr; // graphics item, if materialized
+  bool          is_critical = false; // see GraphViewer::compute_critical_path
+  LinkTelemetry telemetry;           // items only refer to it
+
+  // ports on the summary node replacing a hidden end, -1 if the link is
+  // not shown at all (internal to a collapsed group)
+  int summary_port_out = -1;
+  int summary_port_in = -1;
+
+  // ends actually drawn, rerouted to the summary node if hidden
+  NodeRecord *get_shown_node_in() const;
+  NodeRecord *get_shown_node_out() const;
+  int         get_shown_port_in() const;
+  int         get_shown_port_out() const;
+  bool        is_hidden() const;
+
+  nlohmann::json json_to(LinkType link_type) const; // same format as GraphicsLink
+  QRectF         rect() const;
+};
+
+/**
+ * Proxy of the node standing for a collapsed group. Its ports are the connections
+ * crossing the group boundary, the data stays on the member nodes.
+ */
+class GroupNodeProxy : public NodeProxy
+{
+public:
+  GroupNodeProxy(const std::string &id, const std::string &caption);
+
+  int add_port(NodeProxy *p_member, int member_port);
+
+  std::string get_id() const override { return this->id; }
+  void        set_id(const std::string &new_id) override { this->id = new_id; }
+  std::string get_caption() const override { return this->caption; }
+  std::string get_category() const override { return std::string(); }
+  std::string get_tool_tip_text() const override;
+  int         get_nports() const override { return (int)this->ports.size(); }
+  std::string get_port_caption(int port_index) const override;
+  std::string get_port_id(int port_index) const override;
+  PortType    get_port_type(int port_index) const override;
+  std::string get_data_type(int port_index) const override;
+  void       *get_data_ref(int /* port_index */) const override { return nullptr; }
+
+private:
+  struct Port
+  {
+    QPointer<NodeProxy> p_member;
+    int                 member_port;
+    PortType            type;
+  };
+
+  std::string       id;
+  std::string       caption;
+  std::vector<Port> ports;
+};
+
+struct CollapsedGroup
+{
+  std::unique_ptr<GroupNodeProxy> p_proxy;
+  NodeRecord                      summary;
+  std::vector<NodeRecord *>       members;
+  QPointF                         origin; // summary position when collapsed
+};
+
+/**
+ * Graph edits gathered over an event loop turn, reported at once to the host (see
+ * GraphViewer::graph_changed). Edits undone within the same turn cancel out and a
+ * replaced link is listed as removed along with its replacement.
+ */
+struct ChangeSet
+{
+  struct Node
+  {
+    std::string id;
+    NodeHandle  handle = NULL_NODE_HANDLE;
+  };
+
+  struct Link
+  {
+    std::string id_out;
+    std::string port_id_out;
+    std::string id_in;
+    std::string port_id_in;
+    NodeHandle  node_out = NULL_NODE_HANDLE;
+    int         port_out = -1;
+    NodeHandle  node_in = NULL_NODE_HANDLE;
+    int         port_in = -1;
+
+    static Link from_record(const LinkRecord &record);
+
+    // same ends, the string ids are not compared
+    bool operator==(const Link &other) const;
+  };
+
+  std::vector<Node> added_nodes;
+  std::vector<Node> removed_nodes;
+  std::vector<Link> added_links;
+  std::vector<Link> removed_links;
+
+  void add_link(const Link &link);
+  void add_node(const Node &node);
+  bool is_empty() const;
+  void remove_link(const Link &link);
+  void remove_node(const Node &node);
+};
+
+/**
+ * Longest chain of node computes of the last pass, which bounds its wall time (see
+ * GraphViewer::compute_critical_path). Durations in milliseconds.
+ */
+struct CriticalPath
+{
+  double                  total_duration = 0.0;
+  std::vector<NodeHandle> nodes; // upstream first
+
+  // per node of the analysis, how much longer it could have run without delaying
+  // the pass, 0 for the critical nodes
+  std::unordered_map<NodeHandle, double> slacks;
+};
+
+// rough node size estimate, refined once the node is materialized
+QSizeF estimate_node_size(NodeProxy *p_proxy);
+
+/**
+ * Uniform grid spatial hash used to find the records intersecting a given scene
+ * rectangle. Items spanning more than `max_cells` cells are kept aside and always
+ * returned by queries.
+ */
+template <typename T> class SpatialHash
+{
+public:
+  explicit SpatialHash(float cell_size = 512.f, int max_cells = 64)
+      : cell_size(cell_size), max_cells(max_cells)
+  {
+  }
+
+  void clear()
+  {
+    this->cells.clear();
+    this->spans.clear();
+    this->oversized.clear();
+  }
+
+  void insert(T item, const QRectF &rect)
+  {
+    Span span = this->get_span(rect);
+
+    if ((span.x1 - span.x0 + 1) * (span.y1 - span.y0 + 1) > this->max_cells)
+    {
+      span.is_oversized = true;
+      this->oversized.push_back(item);
+    }
+    else
+    {
+      for (int j = span.y0; j <= span.y1; j++)
+        for (int i = span.x0; i <= span.x1; i++)
+          this->cells[this->get_key(i, j)].push_back(item);
+    }
+
+    this->spans[item] = span;
+  }
+
+  void move(T item, const QRectF &rect)
+  {
+    // nothing to do if the item remains in the same cells
+    auto it = this->spans.find(item);
+    if (it != this->spans.end() && it->second == this->get_span(rect))
+      return;
+
+    this->remove(item);
+    this->insert(item, rect);
+  }
+
+  void query(const QRectF &rect, std::vector<T> &items) const
+  {
+    const Span   span = this->get_span(rect);
+    const size_t start = items.size();
+
+    for (int j = span.y0; j <= span.y1; j++)
+      for (int i = span.x0; i <= span.x1; i++)
+      {
+        auto it = this->cells.find(this->get_key(i, j));
+        if (it != this->cells.end())
+          items.insert(items.end(), it->second.begin(), it->second.end());
+      }
+
+    items.insert(items.end(), this->oversized.begin(), this->oversized.end());
+
+    // items spanning several cells are only reported once
+    std::sort(items.begin() + start, items.end());
+    items.erase(std::unique(items.begin() + start, items.end()), items.end());
+  }
+
+  // estimated heap footprint, in bytes
+  size_t get_memory_usage() const
+  {
+    const size_t node_overhead = 2 * sizeof(void *); // hash table node and bucket
+
+    size_t bytes = this->oversized.capacity() * sizeof(T) +
+                   this->spans.size() * (sizeof(std::pair<T, Span>) + node_overhead);
+
+    for (auto &[_, cell] : this->cells)
+      bytes += sizeof(std::pair<uint64_t, std::vector<T>>) + node_overhead +
+               cell.capacity() * sizeof(T);
+
+    return bytes;
+  }
+
+  void remove(T item)
+  {
+    auto it = this->spans.find(item);
+    if (it == this->spans.end())
+      return;
+
+    const Span &span = it->second;
+
+    if (span.is_oversized)
+      std::erase(this->oversized, item);
+    else
+      for (int j = span.y0; j <= span.y1; j++)
+        for (int i = span.x0; i <= span.x1; i++)
+        {
+          auto cell_it = this->cells.find(this->get_key(i, j));
+          std::erase(cell_it->second, item);
+          if (cell_it->second.empty())
+            this->cells.erase(cell_it);
+        }
+
+    this->spans.erase(it);
+  }
+
+private:
+  struct Span
+  {
+    int  x0, y0, x1, y1;
+    bool is_oversized = false;
+
+    bool operator==(const Span &other) const
+    {
+      return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+    }
+  };
+
+  uint64_t get_key(int i, int j) const
+  {
+    return (uint64_t(uint32_t(i)) << 32) | uint64_t(uint32_t(j));
+  }
+
+  Span get_span(const QRectF &rect) const
+  {
+    return Span{int(std::floor(rect.left() / this->cell_size)),
+                int(std::floor(rect.top() / this->cell_size)),
+                int(std::floor(rect.right() / this->cell_size)),
+                int(std::floor(rect.bottom() / this->cell_size))};
+  }
+
+  float                                        cell_size;
+  int                                          max_cells;
+  std::unordered_map<uint64_t, std::vector<T>> cells;
+  std::unordered_map<T, Span>                  spans;
+  std::vector<T>                               oversized;
+};
+
+} // namespace gngui
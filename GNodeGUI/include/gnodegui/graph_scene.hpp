@@ -0,0 +1,130 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file graph_scene.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Graphics scene holding the graph state (records, spatial indexes, graphics
+ * items) shared by all the GraphViewer views attached to it.
+ *
+ * The scene is created and owned by a main GraphViewer. Additional views (split
+ * view, second window...) attach to it and only add their own transform and
+ * overlay, items are not duplicated. Node interactions are always reported through
+ * the main viewer. The views still attached when the main viewer is deleted are
+ * detached from the scene beforehand.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <atomic>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QGraphicsScene>
+
+#include "gnodegui/command_queue.hpp"
+#include "gnodegui/compute_events.hpp"
+#include "gnodegui/graph_records.hpp"
+#include "gnodegui/graphics_group.hpp"
+#include "gnodegui/graphics_link.hpp"
+#include "gnodegui/thumbnail_cache.hpp"
+
+namespace gngui
+{
+
+class GraphViewer; // forward decl
+
+class GraphScene : public QGraphicsScene
+{
+public:
+  explicit GraphScene(GraphViewer *p_main_viewer);
+  ~GraphScene();
+
+  GraphViewer               *get_main_viewer() const { return this->p_main_viewer; }
+  std::vector<GraphViewer *> get_viewers() const; // main viewer included
+
+  // graph edits are ignored, see GraphViewer::set_busy
+  bool is_read_only() const { return this->is_busy; }
+
+  const DataflowOverlay &get_dataflow_overlay() const { return this->dataflow_overlay; }
+
+  const TelemetryOverlay &get_telemetry_overlay() const
+  {
+    return this->telemetry_overlay;
+  }
+
+private:
+  // the state is managed by the viewers
+  friend class GraphViewer;
+
+  GraphViewer *p_main_viewer; // owner
+
+  std::string id;
+
+  // all nodes available store as a map of (node type, node category)
+  std::map<std::string, std::string> node_inventory;
+
+  GraphicsLink *temp_link = nullptr;   // Temporary link
+  GraphicsNode *source_node = nullptr; // Source node for the connection
+  LinkType      current_link_type = LinkType::CUBIC;
+  bool          is_busy = false;
+
+  // graph records, with or without graphics items
+  std::unordered_map<std::string, NodeRecord>                   node_records;
+  std::unordered_map<LinkRecord *, std::unique_ptr<LinkRecord>> link_records;
+  std::unordered_map<NodeHandle, NodeRecord *>                  handle_records;
+  NodeHandle                                                    next_handle = 1;
+  SpatialHash<NodeRecord *>                                     node_grid;
+  SpatialHash<LinkRecord *>                                     link_grid;
+  std::unordered_set<NodeRecord *>                              materialized_nodes;
+  std::unordered_set<LinkRecord *>                              materialized_links;
+
+  // links materialized during a bulk load, their paths are computed together at the
+  // end of it (see GraphViewer::LinkPathBatch)
+  std::unordered_set<GraphicsLink *> pending_link_paths;
+  int                                link_path_batch_depth = 0;
+
+  std::unordered_map<GraphicsGroup *, std::unique_ptr<CollapsedGroup>> collapsed_groups;
+
+  std::list<GraphicsNode *> live_widget_nodes; // most recently visible first
+
+  // released items, out of the scene and kept for reuse (owned by this)
+  std::vector<GraphicsLink *> link_pool;
+  std::vector<GraphicsNode *> node_pool;
+
+  // commands from any thread, applied by the main viewer (see
+  // GraphViewer::push_command)
+  std::unique_ptr<CommandQueue<ViewerCommand>> command_queue;
+  std::atomic<bool>                            is_command_drain_scheduled = false;
+
+  // overflow of a full command queue, applied after it. Once not empty, every
+  // command goes there until drained, to keep them in order
+  std::deque<ViewerCommand> spilled_commands;
+  std::mutex                spilled_commands_mutex;
+  std::atomic<bool>         has_spilled_commands = false;
+
+  // edits not reported yet (see GraphViewer::graph_changed)
+  ChangeSet pending_changes;
+  bool      is_graph_changed_scheduled = false;
+
+  // interactions of every node are reported through this single instance
+  GraphicsNodeCallbacks node_callbacks;
+
+  TelemetryOverlay telemetry_overlay; // see GraphViewer::set_telemetry_overlay
+  DataflowOverlay  dataflow_overlay;  // see GraphViewer::set_dataflow_overlay
+  ComputeEventLog  compute_events;    // see GraphViewer::get_compute_events
+  int64_t          pass_start_time = -1; // see GraphViewer::compute_critical_path
+
+  ThumbnailCache *thumbnail_cache = nullptr; // owned by this
+};
+
+} // namespace gngui
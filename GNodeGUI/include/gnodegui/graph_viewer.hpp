@@ -3,20 +3,51 @@
  * this software. */
 #pragma once
 #include <functional>
+#include <memory>
+#include <span>
 
+#include <QElapsedTimer>
 #include <QGraphicsItem>
 #include <QGraphicsView>
 #include <QJsonObject>
+#include <QMouseEvent>
+#include <QTimer>
 
 #include "nlohmann/json.hpp"
 
+#include "gnodegui/command_queue.hpp"
+#include "gnodegui/graph_export.hpp"
+#include "gnodegui/graph_records.hpp"
+#include "gnodegui/graph_scene.hpp"
+#include "gnodegui/graphics_group.hpp"
 #include "gnodegui/graphics_link.hpp"
 #include "gnodegui/graphics_node.hpp"
 #include "gnodegui/node_proxy.hpp"
+#include "gnodegui/stats.hpp"
+#include "gnodegui/thumbnail_cache.hpp"
 
 namespace gngui
 {
 
+// estimated memory footprint of a graph, in bytes (see GraphViewer::memory_report).
+// Qt internal item data and host node widgets are not accounted for
+struct MemoryReport
+{
+  size_t graphics_nodes = 0;
+  size_t graphics_links = 0;
+  size_t node_geometries = 0; // shared between the nodes with the same layout
+  size_t node_records = 0;
+  size_t link_records = 0;
+  size_t spatial_indexes = 0;
+  size_t thumbnails = 0;
+
+  size_t graphics_nodes_count = 0;
+  size_t graphics_links_count = 0;
+
+  nlohmann::json json_to() const;
+  size_t         total() const;
+};
+
 class GraphViewer : public QGraphicsView
 {
   Q_OBJECT
@@ -24,6 +55,15 @@ class GraphViewer : public QGraphicsView
 public:
   explicit GraphViewer(std::string id = "graph", QWidget *parent = nullptr);
 
+  // additional view of the graph of 'p_main_viewer': the scene, and thus every
+  // item, is shared and only the transform and the overlay (toolbar) are specific
+  // to this view. Its signals are forwarded to the main viewer. The main viewer
+  // owns the scene: once deleted, its additional views are detached from it (empty
+  // and disabled) and must only be deleted
+  explicit GraphViewer(GraphViewer *p_main_viewer, QWidget *parent = nullptr);
+
+  ~GraphViewer();
+
   // --- Serializzation
 
   void           json_from(nlohmann::json json, bool clear_existing_content = true);
@@ -36,6 +76,10 @@ public:
                        const std::string &port_id_out,
                        const std::string &to_in,
                        const std::string &port_id_in);
+  void        add_link(NodeHandle node_out,
+                       int        port_out,
+                       NodeHandle node_in,
+                       int        port_in);
   std::string add_node(NodeProxy         *p_node_proxy,
                        QPointF            scene_pos,
                        const std::string &node_id = "");
@@ -48,12 +92,33 @@ public:
 
   // --- Editing
 
+  // a collapsed group shows a single summary node in place of its member nodes,
+  // with the connections crossing the group boundary rerouted to it. This is
+  // display only, the graph itself is left as is
+  void collapse_group(GraphicsGroup *p_group);
+  void expand_group(GraphicsGroup *p_group);
+
   void                     deselect_all();
   std::vector<std::string> get_selected_node_ids(
       std::vector<QPointF> *p_scene_pos_list = nullptr);
-  void select_all();
-  void set_node_as_selected(const std::string &node_id);
-  void unpin_nodes();
+  std::vector<NodeHandle>  get_selected_node_handles() const;
+  void                     select_all();
+  void                     set_node_as_selected(const std::string &node_id);
+  void                     set_node_as_selected(NodeHandle handle);
+  void                     unpin_nodes();
+
+  // emits 'graph_changed' right away if any edit is pending, instead of waiting for
+  // the event loop
+  void flush_changes();
+
+  // --- Node handles
+
+  // integer counterparts of the node and port ids (see NodeHandle), mapped both
+  // ways. Invalid ids give NULL_NODE_HANDLE or -1, invalid handles an empty string
+  NodeHandle  get_node_handle(const std::string &node_id) const;
+  std::string get_node_id(NodeHandle handle) const;
+  int         get_port_index(NodeHandle handle, const std::string &port_id) const;
+  std::string get_port_id(NodeHandle handle, int port_index) const;
 
   // --- UI
 
@@ -64,22 +129,133 @@ public:
 
   // --- Getters
 
-  QRectF        get_bounding_box();
-  GraphicsNode *get_graphics_node_by_id(const std::string &node_id);
-  std::string   get_id() const;
-  QPointF       get_mouse_scene_pos();
+  // with items virtualization (see Style::Viewer::virtualize_items), nodes without
+  // graphics item get one on demand, released later on if out of view
+  QRectF          get_bounding_box();
+  GraphScene     *get_graph_scene() { return this->graph_scene; }
+  GraphicsNode   *get_graphics_node_by_id(const std::string &node_id);
+  std::string     get_id() const;
+  QPointF         get_mouse_scene_pos();
+  ViewerStats     get_stats() const;
+  ThumbnailCache *get_thumbnail_cache() { return this->graph_scene->thumbnail_cache; }
+  MemoryReport    memory_report() const; // shared scene, all the views included
+
+  // this view is being navigated and drawn in draft quality (see
+  // Style::Viewer::draft_during_navigation)
+  bool is_draft_rendering() const { return this->is_navigating; }
 
   // --- Setters
 
+  // busy mode is read-only: graph edits (connections, deletion, node moves, new
+  // nodes) are ignored, navigation, selection and tooltips keep working. Shared by
+  // all the views, the widget enablement is left as is
+  void set_busy(bool state);
+  bool is_busy() const { return this->graph_scene->is_read_only(); }
+
   void set_enabled(bool state);
-  void set_id(const std::string &new_id) { this->id = new_id; }
+  void set_id(const std::string &new_id) { this->graph_scene->id = new_id; }
   void set_node_inventory(const std::map<std::string, std::string> &new_node_inventory);
 
+  // 'stats_updated' is emitted every 'interval' milliseconds, 0 to disable
+  void set_stats_interval(int interval);
+
+  // register a port data preview, drawn in the body of the nodes having an output of
+  // this data type (see ThumbnailCache)
+  void set_thumbnail_converter(const std::string &data_type,
+                               ThumbnailConverter converter);
+
+  // --- Compute status
+
+  // bulk counterpart of the compute slots, the nodes are repainted once at the next
+  // frame. DONE and CACHED mean new data, as for 'on_compute_finished'
+  void set_compute_state(std::span<const NodeHandle> handles, ComputeState state);
+  void set_compute_state(std::span<const std::string> node_ids, ComputeState state);
+
+  // --- Compute telemetry
+
+  // per-node metrics (see NodeTelemetry). Durations and compute count are measured
+  // from the compute state changes, at frame resolution for the queued commands
+  // without time. Memory and output size are reported by the host
+  NodeTelemetry get_node_telemetry(NodeHandle handle) const;
+  void          reset_telemetry();
+  void          set_node_metric(NodeHandle handle, TelemetryMetric metric, double value);
+
+  // node headers colored by 'metric' (heatmap), with its value
+  void set_telemetry_overlay(bool            state,
+                             TelemetryMetric metric = TelemetryMetric::DURATION);
+
+  // longest chain of the last pass through the links, from the measured durations
+  // (see CriticalPath). The pass starts with 'on_update_started', the nodes not
+  // computed since then take no time. Slacks are also stored in the node telemetry
+  CriticalPath compute_critical_path();
+
+  // critical nodes and links highlighted, the analysis is then refreshed at the end
+  // of each pass (see 'critical_path_updated')
+  void set_critical_path_visible(bool state);
+
+  // --- Dataflow telemetry
+
+  // per-link metrics reported by the host (see LinkTelemetry), for a single link or
+  // all the links of an output port. Links are repainted once at the next frame.
+  // Returns false if there is no such link
+  LinkTelemetry get_link_telemetry(NodeHandle node_out,
+                                   int        port_out,
+                                   NodeHandle node_in,
+                                   int        port_in) const;
+  bool          set_link_metric(NodeHandle node_out,
+                                int        port_out,
+                                NodeHandle node_in,
+                                int        port_in,
+                                LinkMetric metric,
+                                double     value);
+  bool          set_port_metric(NodeHandle node_out,
+                                int        port_out,
+                                LinkMetric metric,
+                                double     value);
+
+  // link strokes scaled by 'width_metric' and colored by 'color_metric', with a
+  // legend in the bottom left corner of the views
+  void set_dataflow_overlay(bool       state,
+                            LinkMetric width_metric = LinkMetric::BYTES,
+                            LinkMetric color_metric = LinkMetric::TRANSFER_RATE);
+
+  // --- Compute events
+
+  // compute starts and ends (RUNNING, then DONE, FAILED or CACHED), in the order
+  // they were applied. Cleared with the graph, see ComputeTimeline
+  void                   clear_compute_events();
+  const ComputeEventLog &get_compute_events() const;
+
+  // --- Commands
+
+  // thread-safe counterpart of the compute and update slots, for the compute
+  // workers: commands are applied in order on the GUI thread, in batches once per
+  // frame. Node handles only, see get_node_handle. Commands are never dropped:
+  // returns false if the queue is full (see Style::Viewer::command_queue_size), the
+  // command then goes through a slower locked overflow list
+  bool push_command(const ViewerCommand &command);
+
   // --- Export
 
+  // streamed in a single pass over the records, for offline analysis of large graphs.
+  // Without format, it is given by the file extension (see GraphExportFormat)
+  bool export_graph(const std::string &fname);
+  bool export_graph(const std::string &fname, GraphExportFormat format);
+
   // useful for debugging graph actual state, after export: to convert, command line: dot
-  // export.dot -Tsvg > output.svg
+  // export.dot -Tsvg > output.svg (or 'neato -n' to keep the node positions)
   void export_to_graphviz(const std::string &fname = "export.dot");
+
+  // renders the scene area 'scene_rect' (whole graph if empty) at 'scale' pixels per
+  // scene unit, overlay excluded. Format is given by the file extension: 'svg' and
+  // 'pdf' are vector outputs, 'png' is rendered tile by tile to a file streamed to
+  // disk (memory use does not depend on the image size), any other extension is an
+  // error. The viewer does not need to be shown, e.g. with the 'offscreen' Qt
+  // platform
+  bool export_image(const std::string &fname,
+                    float              scale = 1.f,
+                    QRectF             scene_rect = QRectF());
+
   void save_screenshot(const std::string &fname = "screenshot.png");
 
 public Q_SLOTS:
@@ -87,7 +263,9 @@ public Q_SLOTS:
   // --- Qt slots
 
   void on_compute_finished(const std::string &node_id);
+  void on_compute_finished_by_handle(NodeHandle handle);
   void on_compute_started(const std::string &node_id);
+  void on_compute_started_by_handle(NodeHandle handle);
   void on_node_reload_request(const std::string &node_id);
   void on_node_settings_request(const std::string &node_id);
   void on_node_right_clicked(const std::string &node_id, QPointF scene_pos);
@@ -112,8 +290,24 @@ Q_SIGNALS:
                            const std::string &port_id_in);
   void connection_started(const std::string &id_from, const std::string &port_id_from);
 
+  // same as above with node handles and port indices, emitted right after
+  void connection_deleted_by_handle(NodeHandle node_out,
+                                    int        port_out,
+                                    NodeHandle node_in,
+                                    int        port_in,
+                                    bool       link_will_be_replaced);
+  void connection_finished_by_handle(NodeHandle node_out,
+                                     int        port_out,
+                                     NodeHandle node_in,
+                                     int        port_in);
+
   // --- Graph signals
 
+  // every edit of the graph (nodes and links added or removed, whatever the origin)
+  // over an event loop turn, i.e. usually a whole user action. Emitted by the main
+  // viewer, in addition to the individual signals
+  void graph_changed(const ChangeSet &changes);
+
   void graph_automatic_node_layout_request();
   void graph_clear_request();
   void graph_import_request();
@@ -140,10 +334,16 @@ Q_SIGNALS:
                                const std::vector<QPointF>     &scene_pos_list);
   void nodes_paste_request();
 
+  // same as above with node handles, emitted right after
+  void node_deselected_by_handle(NodeHandle handle);
+  void node_selected_by_handle(NodeHandle handle);
+
   // --- Global signals
 
   void quit_request();
   void selection_has_changed();
+  void stats_updated(const ViewerStats &stats); // see set_stats_interval
+  void critical_path_updated(const CriticalPath &critical_path);
   void viewport_request();
   void rubber_band_selection_started();
   void rubber_band_selection_finished();
@@ -153,13 +353,16 @@ protected:
 
   void contextMenuEvent(QContextMenuEvent *event) override;
   void delete_selected_items();
+  void drawBackground(QPainter *painter, const QRectF &rect) override;
   void drawForeground(QPainter *painter, const QRectF &rect) override;
   void keyPressEvent(QKeyEvent *event) override;
   void keyReleaseEvent(QKeyEvent *event) override;
   void mouseMoveEvent(QMouseEvent *event) override;
   void mousePressEvent(QMouseEvent *event) override;
   void mouseReleaseEvent(QMouseEvent *event) override;
+  void paintEvent(QPaintEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
+  void scrollContentsBy(int dx, int dy) override;
   void wheelEvent(QWheelEvent *event) override;
 
 private Q_SLOTS:
@@ -173,24 +376,138 @@ private Q_SLOTS:
 
   void on_connection_started(GraphicsNode *from_node, int port_index);
 
+  void on_signal_emitted(); // signals counting, main viewer only
+
 private:
   void delete_graphics_link(GraphicsLink *, bool prevent_graph_update = false);
   void delete_graphics_node(GraphicsNode *p_node);
+  void detach_scene(); // additional view, before the scene deletion
   bool is_item_static(QGraphicsItem *item);
+  void setup_node_callbacks(); // main viewer only
+  void setup_view();
+
+  // --- Export
+
+  bool export_png(const std::string &fname, float scale, const QRectF &scene_rect);
+  bool export_vector(const std::string &fname, float scale, const QRectF &scene_rect);
+  void render_scene_area(QPainter *painter, const QRectF &target, const QRectF &source);
+
+  // --- Items recycling
+
+  // released nodes and links go to the scene pools (see
+  // Style::Viewer::max_pooled_items) and are reset when taken back
+  GraphicsLink *acquire_link(QColor color, LinkType link_type);
+  GraphicsNode *acquire_node(QPointer<NodeProxy> p_proxy);
+  void          recycle_link(GraphicsLink *p_link);
+  void          recycle_node(GraphicsNode *p_node);
+
+  // --- Interactive rendering quality
+
+  void start_navigation();
+  void stop_navigation();
+
+  // --- Input and commands coalescing
+
+  void apply_command(const ViewerCommand &command);
+  // 'time' from get_time_ns, current time if 0. 'thread_id' is host-defined
+  void apply_compute_state(NodeRecord  *p_record,
+                           ComputeState state,
+                           bool         update_item,
+                           int64_t      time = 0,
+                           uint32_t     thread_id = 0);
+  void apply_zoom(float factor, QPoint anchor_pos);
+  void flush_mouse_move();
+  void process_commands(); // main viewer only
+  void process_frame();
+  void process_mouse_move(QMouseEvent *event);
+  void schedule_compute_repaint(); // all the views
+  void schedule_frame();
+
+  // --- Compute and dataflow telemetry
+
+  void apply_link_metric(LinkRecord *p_record, LinkMetric metric, double value);
+  void draw_dataflow_legend(QPainter *painter); // in viewport coordinates
+  void update_critical_links(); // link items highlight, from their records
+  void update_telemetry(NodeRecord *p_record, ComputeState state, int64_t time);
+
+  // --- Link paths
+
+  // link paths of the links materialized in its scope are computed in parallel when
+  // it ends (outermost scope only)
+  struct LinkPathBatch
+  {
+    explicit LinkPathBatch(GraphViewer *p_viewer);
+    ~LinkPathBatch();
+
+    GraphViewer *p_viewer;
+  };
+
+  void flush_link_paths();
+  // paths built on the scheduler workers, installed in one pass on this thread
+  void update_link_paths(const std::vector<GraphicsLink *> &links);
+
+  // --- Records and items virtualization
+
+  LinkRecord   *add_link_record(NodeRecord *p_node_out,
+                                int         port_out,
+                                NodeRecord *p_node_in,
+                                int         port_in);
+  void          delete_link_record(LinkRecord *p_record, bool link_will_be_replaced);
+  void          delete_node_record(NodeRecord *p_record);
+  void          draw_records(QPainter *painter, const QRectF &rect);
+  QPointF       get_collapsed_offset(const NodeRecord *p_summary) const;
+  LinkRecord   *get_link_record(GraphicsLink *p_link);
+  LinkRecord   *get_link_record(NodeHandle node_out,
+                                int        port_out,
+                                NodeHandle node_in,
+                                int        port_in) const;
+  NodeRecord   *get_node_record(const std::string &node_id);
+  NodeRecord   *get_node_record(NodeHandle handle) const;
+  bool          is_in_active_area(const QRectF &rect) const; // any view
+  void          materialize_area(const QRectF &rect);
+  GraphicsLink *materialize_link(LinkRecord *p_record);
+  GraphicsNode *materialize_node(NodeRecord *p_record);
+  void          release_link(LinkRecord *p_record);
+  void          release_node(NodeRecord *p_record);
+  void          schedule_graph_changed();
+  void          schedule_items_update();
+  void          sync_node_record(NodeRecord *p_record);
+  void          update_items(bool force = false);
+
+  // --- Node widgets virtualization
+
+  void schedule_widgets_update();
+  void touch_live_widget(GraphicsNode *p_node);
+  void update_widgets();
 
   // --- Members
 
-  std::string id;
+  // graph state, shared with the other views of the same graph
+  GraphScene *graph_scene = nullptr; // owned by the main viewer, null once detached
 
   std::vector<QGraphicsItem *> static_items; // owned by this
   std::vector<QPoint>          static_items_positions;
 
-  // all nodes available store as a map of (node type, node category)
-  std::map<std::string, std::string> node_inventory;
-
-  GraphicsLink *temp_link = nullptr;   // Temporary link
-  GraphicsNode *source_node = nullptr; // Source node for the connection
-  LinkType      current_link_type = LinkType::CUBIC;
+  QTimer *navigation_timer = nullptr; // owned by this
+  bool    is_navigating = false;
+
+  // input accumulated until the next frame
+  QTimer                      *frame_timer = nullptr; // owned by this
+  QElapsedTimer                frame_clock;           // since the last frame
+  std::unique_ptr<QMouseEvent> pending_mouse_move;
+  float                        pending_zoom_log = 0.f; // log of the zoom factor
+  QPoint                       zoom_anchor_pos;        // viewport coordinates
+  bool                         is_compute_repaint_pending = false;
+
+  // runtime statistics
+  ViewerStats frame_stats; // last frame figures
+  uint64_t    signal_emissions = 0;
+  QTimer     *stats_timer = nullptr; // owned by this
+
+  QRectF active_rect;           // scene area covered by items for this view
+  bool   is_lod_active = false; // records drawn as plain shapes
+  bool   is_items_update_scheduled = false;
+  bool   is_widgets_update_scheduled = false;
 };
 
 } // namespace gngui
@@ -2,6 +2,7 @@
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
 #pragma once
+#include <functional>
 #include <memory>
 
 #include "nlohmann/json.hpp"
@@ -23,8 +24,18 @@ public:
   void           json_from(const nlohmann::json &json);
   nlohmann::json json_to() const;
 
+  std::string get_caption() const;
+  bool        get_is_collapsed() const { return this->is_collapsed; }
+
   void set_caption(const std::string &new_caption);
   void set_color(const QColor &new_color);
+  void set_is_collapsed(bool new_state);
+
+  // --- Callbacks - "signals" equivalent
+
+  // collapse / expand requested from the context menu, handled by the
+  // viewer which owns the nodes and links inside the group
+  std::function<void(GraphicsGroup *group)> collapse_toggled;
 
 protected:
   enum Corner
@@ -61,6 +72,7 @@ private:
   QColor             color;
 
   bool is_hovered = false;
+  bool is_collapsed = false;
 
   bool    resizing;
   QPointF resize_start_pos;
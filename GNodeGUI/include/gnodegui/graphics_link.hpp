@@ -6,8 +6,10 @@
 #include <vector>
 
 #include <QGraphicsPathItem>
+#include <QPolygonF>
 
 #include "gnodegui/graphics_node.hpp"
+#include "gnodegui/node_telemetry.hpp"
 #include "nlohmann/json.hpp"
 
 namespace gngui
@@ -40,19 +42,32 @@ public:
 
   // --- Getters
 
+  // port positions in scene coordinates, false for a link not established yet
+  bool          get_endpoints(QPointF &start_point, QPointF &end_point) const;
+  LinkType      get_link_type() const { return this->link_type; }
   GraphicsNode *get_node_out() { return this->node_out; }
   GraphicsNode *get_node_in() { return this->node_in; }
   int           get_port_out_index() const { return this->port_out_index; }
   int           get_port_in_index() const { return this->port_in_index; }
 
+  // estimated footprint in bytes, Qt internal item data excluded
+  size_t get_memory_usage() const;
+
   // --- Node / Link Management
+
+  // back to a freshly constructed state, to be reused for another connection (the
+  // link must not be in a scene)
+  void     reset(QColor new_color, LinkType new_link_type);
   void     set_endnodes(GraphicsNode *from,
                         int           port_from_index,
                         GraphicsNode *to,
                         int           port_to_index);
   void     set_endpoints(const QPointF &start_point, const QPointF &end_point);
+  void     set_is_critical(bool new_state); // critical path highlight
+  void     set_link_path(const QPainterPath &new_path); // see build_link_path
   void     set_link_type(const LinkType &new_link_type);
   void     set_pen_style(const Qt::PenStyle &new_pen_style);
+  void     set_telemetry(const LinkTelemetry *new_p_telemetry); // dataflow overlay
   LinkType toggle_link_type();
   void     update_path();
 
@@ -68,25 +83,42 @@ protected:
   QPainterPath shape() const override;
 
 private:
+  // the nodes ports no longer refer to this link
+  void release_ports();
+
+  // repaint only the band around the path instead of its whole bounding rect
+  void update_stroke();
+
   // --- Members
 
   // visual properties
-  QColor                color;
-  LinkType              link_type;
-  Qt::PenStyle          pen_style = Qt::DashLine;
-  bool                  is_link_hovered = false;
-  std::vector<LinkType> link_types = {LinkType::BROKEN_LINE,
-                                      LinkType::CIRCUIT,
-                                      LinkType::CUBIC,
-                                      LinkType::DEPORTED,
-                                      LinkType::LINEAR,
-                                      LinkType::QUADRATIC};
+  QColor       color;
+  LinkType     link_type;
+  Qt::PenStyle pen_style = Qt::DashLine;
+  QPolygonF    draft_polyline; // coarse path used for draft rendering
+
+  const LinkTelemetry *p_telemetry = nullptr; // owned by the link record
 
   // node endpoints
   GraphicsNode *node_out = nullptr;
   GraphicsNode *node_in = nullptr;
-  int           port_out_index;
-  int           port_in_index;
+  int           port_out_index = -1;
+  int           port_in_index = -1;
+
+  // last, with the endpoints indices to limit padding
+  bool is_link_hovered = false;
+  bool is_critical = false;
 };
 
+// --- helper
+
+// path of a link of type 'link_type' between two ports. Pure function, it can be
+// called from any thread (see GraphViewer::update_link_paths)
+QPainterPath build_link_path(const QPointF &start_point,
+                             const QPointF &end_point,
+                             LinkType       link_type);
+
+// link type following 'link_type' in the toggling sequence
+LinkType get_next_link_type(LinkType link_type);
+
 } // namespace gngui
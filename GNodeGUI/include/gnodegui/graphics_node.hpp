@@ -8,6 +8,7 @@
 #include <QEvent>
 #include <QGraphicsRectItem>
 #include <QMouseEvent>
+#include <QPixmap>
 #include <QPointer>
 #include <QWidget>
 
@@ -17,11 +18,41 @@
 #include "gnodegui/graphics_node_geometry.hpp"
 #include "gnodegui/logger.hpp"
 #include "gnodegui/node_proxy.hpp"
+#include "gnodegui/node_telemetry.hpp"
+#include "gnodegui/thumbnail_cache.hpp"
 
 namespace gngui
 {
 
 class GraphicsLink; // forward decl
+class GraphicsNode; // forward decl
+
+// compute status of a node, as reported by the host
+enum ComputeState : uint8_t
+{
+  IDLE, // nothing reported
+  QUEUED,
+  RUNNING,
+  DONE,
+  FAILED,
+  CACHED, // done, result taken from a cache
+};
+
+// node interactions handlers, a single instance is shared by all the nodes of a scene
+// (see GraphicsNode::set_callbacks)
+struct GraphicsNodeCallbacks
+{
+  std::function<void(GraphicsNode *from, int port_index, QPointF scene_pos)>
+      connection_dropped;
+  std::function<
+      void(GraphicsNode *from, int port_from_index, GraphicsNode *to, int port_to_index)>
+                                                                connection_finished;
+  std::function<void(GraphicsNode *from, int port_index)>       connection_started;
+  std::function<void(const std::string &id)>                    selected;
+  std::function<void(const std::string &id)>                    deselected;
+  std::function<void(const std::string &id, QPointF scene_pos)> right_clicked;
+  std::function<void(GraphicsNode *node)>                       widget_activated;
+};
 
 class GraphicsNode : public QGraphicsRectItem
 {
@@ -29,6 +60,11 @@ public:
   GraphicsNode(QPointer<NodeProxy> p_proxy, QGraphicsItem *parent = nullptr);
   ~GraphicsNode();
 
+  // back to a freshly constructed state for the node 'new_p_proxy', to be reused
+  // for another node (the node must not be in a scene). Without proxy, the node
+  // only lets go of its current state
+  void reset(QPointer<NodeProxy> new_p_proxy);
+
   // --- Serializzation
 
   void           json_from(const nlohmann::json &json);
@@ -40,8 +76,13 @@ public:
   std::string                 get_category() const;
   std::vector<std::string>    get_category_splitted(char delimiter = '/') const;
   std::string                 get_data_type(int port_index) const;
+  ComputeState                get_compute_state() const;
+  uint64_t                    get_data_version() const;
   const GraphicsNodeGeometry &get_geometry() const;
   std::string                 get_id() const;
+  bool                        get_is_node_computing() const;
+  bool                        get_is_node_pinned() const;
+  bool                        get_is_widget_visible() const;
   std::string                 get_main_category() const;
   int                         get_nports() const;
   std::string                 get_port_caption(int port_index) const;
@@ -49,35 +90,47 @@ public:
   int                         get_port_index(const std::string &id) const;
   PortType                    get_port_type(int port_index) const;
   const NodeProxy            *get_proxy_ref() const;
+  std::function<QWidget *()>  get_widget_factory() const;
+  QSizeF                      get_widget_size() const;
+  bool                        has_widget() const;
   bool                        is_port_available(int port_index);
+  bool                        is_read_only() const; // see GraphScene::is_read_only
+  bool                        is_widget_live() const;
+
+  // estimated footprint in bytes, widget snapshot included. The geometry (shared),
+  // the widget and Qt internal item data are excluded
+  size_t get_memory_usage() const;
 
   // --- Setters
 
+  void set_callbacks(const GraphicsNodeCallbacks *new_p_callbacks);
+  // no repaint without 'update_item', left to the caller (e.g. bulk updates)
+  void set_compute_state(ComputeState new_state, bool update_item = true);
+  void set_data_version(uint64_t new_data_version);
+  void set_telemetry(const NodeTelemetry *new_p_telemetry); // drawn by the overlay
   void set_is_node_pinned(bool new_state);
   void set_is_port_connected(int port_index, GraphicsLink *p_link);
   void set_p_proxy(QPointer<NodeProxy> new_p_proxy);
+  void set_thumbnail_cache(ThumbnailCache *new_p_thumbnail_cache);
 
+  // widget owned by the host, replaces any widget factory. Widgets built by the
+  // factory are owned by the node and released when it is deleted or recycled
   void set_widget(QWidget *new_widget, QSize widget_size = QSize());
+  void set_widget_factory(std::function<QWidget *()> new_widget_factory,
+                          QSize                      widget_size = QSize());
+  void set_widget_live(bool new_state);
   void set_widget_visibility(bool is_visible);
 
   // --- UI
 
   void update_geometry();
+  void update_thumbnail();
 
   // --- "slots" equivalent
-  void on_compute_finished();
-  void on_compute_started();
 
-  // --- Callbacks - "signals" equivalent
-  std::function<void(GraphicsNode *from, int port_index, QPointF scene_pos)>
-      connection_dropped;
-  std::function<
-      void(GraphicsNode *from, int port_from_index, GraphicsNode *to, int port_to_index)>
-                                                                connection_finished;
-  std::function<void(GraphicsNode *from, int port_index)>       connection_started;
-  std::function<void(const std::string &id)>                    selected;
-  std::function<void(const std::string &id)>                    deselected;
-  std::function<void(const std::string &id, QPointF scene_pos)> right_clicked;
+  // DONE state, new data: the data version is bumped
+  void on_compute_finished(bool update_item = true);
+  void on_compute_started(bool update_item = true); // RUNNING state
 
 protected:
   // --- Qt methods override
@@ -89,39 +142,62 @@ protected:
   void     mouseMoveEvent(QGraphicsSceneMouseEvent *event);
   void     mousePressEvent(QGraphicsSceneMouseEvent *event) override;
   void     mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
-  bool     sceneEventFilter(QGraphicsItem *watched, QEvent *event) override;
 
   virtual void paint(QPainter                       *painter,
                      const QStyleOptionGraphicsItem *option,
                      QWidget                        *widget) override;
 
 private:
-  QSizeF get_widget_size() const;
+  // the factory, if any, is kept (see set_widget_live)
+  void install_widget(QWidget *new_widget, QSize new_widget_size);
+  void release_widget();
 
   // --- Hover state
 
   int  get_hovered_port_index() const;
+  void reset_connection_hover();
+  void update_connection_hover(GraphicsNode *p_from, QPointF scene_pos);
   bool update_is_port_hovered(QPointF scene_pos);
   void update_links();
   void reset_is_port_hovered();
 
+  // --- Partial repaints
+
+  void update_border_band();
+  void update_port(int port_index);
+  void update_ports();
+
   // --- Members
 
-  QPointer<NodeProxy>         p_proxy;
-  GraphicsNodeGeometry        geometry;
-  std::string                 current_comment;
-  QSizeF                      current_widget_size;
-  bool                        is_node_dragged = false;
-  bool                        is_node_hovered = false;
-  bool                        is_node_pinned = false;
-  std::vector<bool>           is_port_hovered;
-  std::vector<GraphicsLink *> connected_link_ref; // owned by GraphViewer
-  bool                        is_node_computing = false;
-  bool                        is_widget_visible = true;
-  bool                        has_connection_started = false;
-  int                         port_index_from;
-  std::string                 data_type_connecting = "";
-  QGraphicsProxyWidget       *proxy_widget = nullptr; // owned by this
+  const GraphicsNodeCallbacks *p_callbacks = nullptr; // shared, owned by GraphScene
+
+  QPointer<NodeProxy>                         p_proxy;
+  std::shared_ptr<const GraphicsNodeGeometry> geometry =
+      GraphicsNodeGeometry::get_shared(nullptr); // shared between nodes
+  std::unique_ptr<GraphicsLink *[]> connected_link_ref;  // one per port
+  size_t                                      comment_hash = 0;
+
+  QSizeF                     current_widget_size;
+  GraphicsNode              *p_connection_target = nullptr; // node under the cursor
+  std::string                data_type_connecting = "";
+  QGraphicsProxyWidget      *proxy_widget = nullptr; // owned by this
+  std::function<QWidget *()> widget_factory;
+  QPixmap                    widget_snapshot; // drawn in place of a non-live widget
+  ThumbnailCache            *p_thumbnail_cache = nullptr; // owned by GraphScene
+  const NodeTelemetry       *p_telemetry = nullptr;       // owned by the node record
+  uint64_t                   data_version = 0;            // bumped after each compute
+
+  // small fields grouped to limit padding
+  int          nports_capacity = 0; // size of 'connected_link_ref'
+  int          hovered_port_index = -1;
+  int          port_index_from = -1;
+  int          thumbnail_port_index = -1;
+  ComputeState compute_state = ComputeState::IDLE;
+  bool         is_node_dragged = false;
+  bool         is_node_hovered = false;
+  bool         is_node_pinned = false;
+  bool         is_widget_visible = true;
+  bool         has_connection_started = false;
 };
 
 // --- helper
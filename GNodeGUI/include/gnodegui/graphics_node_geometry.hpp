@@ -2,6 +2,8 @@
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
 #pragma once
+#include <memory>
+#include <vector>
 
 #include "gnodegui/node_proxy.hpp"
 
@@ -18,7 +20,19 @@ class GraphicsNodeGeometry
 {
 public:
   GraphicsNodeGeometry() = default;
-  GraphicsNodeGeometry(NodeProxy *p_node_proxy, QSizeF widget_size = QSizeF(0.f, 0.f));
+  GraphicsNodeGeometry(NodeProxy *p_node_proxy,
+                       QSizeF     widget_size = QSizeF(0.f, 0.f),
+                       QSizeF     thumbnail_size = QSizeF(0.f, 0.f));
+
+  // the geometry only depends on the node layout (caption, comment, port types,
+  // widget and thumbnail sizes, the style being fixed), nodes sharing the same layout
+  // share the same instance. An empty geometry is returned if 'p_node_proxy' is nullptr
+  static std::shared_ptr<const GraphicsNodeGeometry> get_shared(
+      NodeProxy *p_node_proxy,
+      QSizeF     widget_size = QSizeF(0.f, 0.f),
+      QSizeF     thumbnail_size = QSizeF(0.f, 0.f));
+
+  size_t get_memory_usage() const; // in bytes
 
   QSizeF  caption_size;
   QPointF caption_pos;
@@ -26,8 +40,9 @@ public:
   QRectF  body_rect;
   QRectF  header_rect;
   QRectF  comment_rect;
-  int     full_width;
-  int     full_height;
+  QRectF  thumbnail_rect;
+  int     full_width = 0;
+  int     full_height = 0;
 
   std::vector<QRectF> port_label_rects;
   std::vector<QRectF> port_rects;
@@ -38,9 +53,10 @@ private:
   void compute_body_and_header();
   void compute_caption(const QFontMetrics &fm);
   void compute_comment_height(const QFontMetrics &fm, const std::string &comment);
-  void compute_full_dimensions(const QSizeF &widget_size);
-  void compute_node_width(const QSizeF &widget_size);
+  void compute_full_dimensions(const QSizeF &widget_size, const QSizeF &thumbnail_size);
+  void compute_node_width(const QSizeF &widget_size, const QSizeF &thumbnail_size);
   void compute_ports(const QFontMetrics &fm);
+  void compute_thumbnail(const QSizeF &thumbnail_size);
   void compute_widget_position();
 
   NodeProxy *p_node_proxy; // Pointer to the associated node proxy
@@ -52,6 +68,7 @@ private:
   float comment_height;
 
   float ports_end_y;
+  float thumbnail_end_y;
 };
 
 } // namespace gngui
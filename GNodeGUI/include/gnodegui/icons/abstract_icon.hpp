@@ -11,7 +11,9 @@
  *        custom graphical paths.
  * @details The AbstractIcon class provides mechanisms for handling hover, click, and
  *          tooltip functionality, and it allows derived classes to define their own
- *          paths by implementing the `set_path` method.
+ *          paths by implementing the `set_path` method. The icon is rendered once,
+ *          drop shadow included, into a pixmap atlas holding its normal, hovered and
+ *          pressed states; painting the icon only blits the relevant atlas cell.
  *
  * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
  *            GNU General Public License. See the file LICENSE for details.
@@ -19,6 +21,8 @@
 
 #pragma once
 #include <QGraphicsPathItem>
+#include <QPainterPath>
+#include <QPixmap>
 
 namespace gngui
 {
@@ -46,6 +50,23 @@ public:
    */
   AbstractIcon(float width, QColor color, float pen_width, QGraphicsItem *parent);
 
+  /**
+   * @brief Returns the bounding rectangle of the icon, drop shadow included.
+   *
+   * @return The bounding rectangle in item coordinates, aligned on integer values.
+   */
+  QRectF boundingRect() const override;
+
+  /**
+   * @brief Renders the icon states (normal, hovered, pressed) into the atlas.
+   *
+   * This is called once at startup by the viewer and then only when the device pixel
+   * ratio or the icon path changes.
+   *
+   * @param device_pixel_ratio The device pixel ratio of the target paint device.
+   */
+  void render_atlas(qreal device_pixel_ratio);
+
   /**
    * @brief Sets the opacity of the icon's pen.
    *
@@ -107,10 +128,32 @@ protected:
    */
   void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
 
+  /**
+   * @brief Draws the icon by copying the atlas cell of the current state.
+   *
+   * @param painter The painter used to draw the icon.
+   * @param option The style options of the item.
+   * @param widget The widget being painted on, if any.
+   */
+  void paint(QPainter                       *painter,
+             const QStyleOptionGraphicsItem *option,
+             QWidget                        *widget) override;
+
+  /**
+   * @brief Sets the icon path and invalidates the atlas.
+   *
+   * Derived classes use this instead of `setPath` so that `paint` does not need to
+   * compare the paths.
+   *
+   * @param new_path The new icon path.
+   */
+  void set_icon_path(const QPainterPath &new_path);
+
   /**
    * @brief Pure virtual function to define the icon's path.
    *
-   * Derived classes must implement this function to set the icon's graphical path.
+   * Derived classes must implement this function to set the icon's graphical path
+   * (through `set_icon_path`).
    */
   virtual void set_path() = 0;
 
@@ -142,5 +185,38 @@ protected:
    * Default value is "tooltip".
    */
   QString tooltip = "tooltip";
+
+private:
+  /**
+   * @brief Interaction states of the icon, also used as atlas cell indices.
+   */
+  enum IconState
+  {
+    NORMAL,
+    HOVERED,
+    PRESSED,
+  };
+
+  /**
+   * @brief Sets the interaction state and schedules a repaint if it changed.
+   *
+   * @param new_state The new interaction state.
+   */
+  void set_state(IconState new_state);
+
+  /**
+   * @brief Current interaction state.
+   */
+  IconState state = IconState::NORMAL;
+
+  /**
+   * @brief Pre-rendered icon states, laid out horizontally in `IconState` order.
+   */
+  QPixmap atlas;
+
+  /**
+   * @brief Device pixel ratio the atlas has been rendered for.
+   */
+  qreal atlas_dpr = 0.f;
 };
 } // namespace gngui
\ No newline at end of file
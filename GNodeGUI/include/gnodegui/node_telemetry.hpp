@@ -0,0 +1,106 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file node_telemetry.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Per-node compute metrics, measured by the viewer (durations, compute count)
+ * or reported by the host (memory, output size), per-link dataflow metrics reported
+ * by the host, and their overlay settings.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include <QColor>
+
+namespace gngui
+{
+
+enum TelemetryMetric : uint8_t
+{
+  DURATION,       // last compute, in milliseconds
+  TOTAL_DURATION, // all the computes, in milliseconds
+  COMPUTE_COUNT,
+  PEAK_MEMORY, // host-reported, in bytes
+  OUTPUT_SIZE, // host-reported, in bytes
+};
+
+struct NodeTelemetry
+{
+  double   duration = 0.0;
+  double   total_duration = 0.0;
+  uint32_t compute_count = 0;
+  uint64_t peak_memory = 0;
+  uint64_t output_size = 0;
+  int64_t  start_time = -1; // steady clock, in nanoseconds, while running
+  int64_t  end_time = -1;   // same, end of the last compute
+
+  // critical path analysis (see GraphViewer::compute_critical_path): how much
+  // longer the node could have run without delaying the pass, in milliseconds,
+  // -1 if the node was not part of the analysis
+  double slack = -1.0;
+  bool   is_critical = false;
+
+  std::string format(TelemetryMetric metric) const; // value with its unit
+  double      get(TelemetryMetric metric) const;
+  void        set(TelemetryMetric metric, double value);
+};
+
+// nodes colored by 'metric', relative to the largest value of the graph
+struct TelemetryOverlay
+{
+  bool            is_visible = false;
+  TelemetryMetric metric = TelemetryMetric::DURATION;
+  double          max_value = 0.0;
+
+  bool is_critical_path_visible = false; // critical nodes and links highlighted
+
+  // log scale, durations and sizes span several orders of magnitude
+  QColor get_color(double value) const;
+};
+
+enum LinkMetric : uint8_t
+{
+  BYTES,         // data volume of the last transfer
+  TRANSFER_RATE, // transfers per second
+  CACHE_HITS,
+  CACHE_MISSES,
+};
+
+struct LinkTelemetry
+{
+  uint64_t bytes = 0;
+  double   transfer_rate = 0.0;
+  uint32_t cache_hits = 0;
+  uint32_t cache_misses = 0;
+
+  std::string format(LinkMetric metric) const; // value with its unit
+  double      get(LinkMetric metric) const;
+  void        set(LinkMetric metric, double value);
+};
+
+// links stroke width scaled by 'width_metric' and color by 'color_metric', relative
+// to the largest values of the graph (log scale, as for TelemetryOverlay)
+struct DataflowOverlay
+{
+  bool       is_visible = false;
+  LinkMetric width_metric = LinkMetric::BYTES;
+  LinkMetric color_metric = LinkMetric::TRANSFER_RATE;
+  double     max_width_value = 0.0;
+  double     max_color_value = 0.0;
+
+  QColor get_color(double value) const;
+  float  get_width(double value) const;
+};
+
+std::string get_link_metric_caption(LinkMetric metric);
+
+// steady clock, in nanoseconds, time base of the telemetry and compute events
+int64_t get_time_ns();
+
+} // namespace gngui
@@ -0,0 +1,63 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file png_stream_writer.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief PNG file written row by row, for images too large to be held in memory.
+ *
+ * Qt image writers need the whole image at once. This writer only keeps the rows it
+ * is given, they are compressed with the zlib streaming deflate and appended to the
+ * file as soon as the compressor output buffer is full: any size can be written
+ * with a bounded memory footprint.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QImage>
+
+struct z_stream_s; // zlib
+
+namespace gngui
+{
+
+class PngStreamWriter
+{
+public:
+  PngStreamWriter(const std::string &fname, int width, int height);
+  ~PngStreamWriter();
+
+  // false if the file could not be opened or if a write failed
+  bool is_valid() const { return this->file.good(); }
+
+  // appends the first 'nrows' rows of 'image', which must have the image width
+  void write_rows(const QImage &image, int nrows);
+
+  // writes the file trailer, rows not provided are left transparent
+  bool close();
+
+private:
+  // feeds 'size' bytes to the compressor, Z_FINISH 'flush' to end the stream
+  void compress(const uint8_t *data, size_t size, int flush);
+  void write_chunk(const char *type, const uint8_t *data, size_t size);
+
+  std::ofstream file;
+  int           width;
+  int           height;
+  int           rows_written = 0;
+  bool          is_closed = false;
+
+  // zlib stream, spanning all the IDAT chunks
+  std::unique_ptr<z_stream_s> p_stream;
+  std::vector<uint8_t>        out_buffer; // one IDAT chunk once full
+};
+
+} // namespace gngui
@@ -0,0 +1,78 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file stats.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Runtime counters and statistics of the graph viewers.
+ *
+ * Graphics items are not aware of the viewer displaying them, their counters are
+ * therefore process wide (`GN_COUNTERS`, GUI thread only). `ViewerStats` gathers
+ * them with the per-viewer figures (item counts, last frame...), see
+ * `GraphViewer::get_stats`.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <cstdint>
+
+#include "nlohmann/json.hpp"
+
+#define GN_COUNTERS gngui::RuntimeCounters::get()
+
+namespace gngui
+{
+
+struct RuntimeCounters
+{
+  static RuntimeCounters *get();
+
+  void reset() { *this = RuntimeCounters(); }
+
+  // paint calls
+  uint64_t node_paints = 0;
+  uint64_t link_paints = 0;
+  uint64_t group_paints = 0;
+  uint64_t comment_paints = 0;
+
+  // work
+  uint64_t link_path_rebuilds = 0;
+  uint64_t geometry_computations = 0; // node geometries actually computed
+  uint64_t geometry_cache_hits = 0;   // shared node geometries reused
+  uint64_t scene_scans = 0;           // iterations over all the scene items
+};
+
+struct ViewerStats
+{
+  // item counts (shared scene)
+  size_t nodes = 0; // graphics items
+  size_t links = 0;
+  size_t groups = 0;
+  size_t comments = 0;
+  size_t node_records = 0; // with or without graphics item
+  size_t link_records = 0;
+
+  // last frame painted by the viewer
+  float    frame_time = 0.f; // ms
+  uint64_t frame_count = 0;
+  uint64_t node_paints = 0;
+  uint64_t link_paints = 0;
+  uint64_t group_paints = 0;
+  uint64_t comment_paints = 0;
+
+  // cumulated, since the start or the last reset
+  uint64_t link_path_rebuilds = 0;
+  uint64_t geometry_computations = 0;
+  uint64_t scene_scans = 0;
+  uint64_t signal_emissions = 0; // by the viewer
+
+  // in [0, 1], 0 if not used yet
+  float geometry_cache_hit_rate = 0.f;
+  float thumbnail_cache_hit_rate = 0.f;
+
+  nlohmann::json json_to() const;
+};
+
+} // namespace gngui
@@ -41,7 +41,60 @@ public:
     bool   add_load_save_icons = true;
     bool   add_group = true;
 
+    // read-only mode while the host updates the graph (see
+    // GraphViewer::set_busy)
     bool disable_during_update = true;
+
+    // cheaper rendering (no antialiasing, simplified links, no text)
+    // while panning or zooming, full quality is restored after
+    // 'draft_idle_timeout' milliseconds without navigation
+    bool draft_during_navigation = true;
+    int  draft_idle_timeout = 200;
+
+    // wheel zoom and mouse moves (panning, dragging) are accumulated and
+    // applied at most once per frame ('frame_interval' milliseconds).
+    // With 'smooth_zoom', the zoom eases toward its target, a fraction
+    // 'smooth_zoom_rate' of the remaining zoom being applied each frame
+    bool  coalesce_input = true;
+    int   frame_interval = 16;
+    bool  smooth_zoom = false;
+    float smooth_zoom_rate = 0.35f;
+
+    // node widgets outside the viewport, or below 'widget_min_zoom', are
+    // replaced by a snapshot. At most 'max_live_widgets' widgets are live
+    // at once (least recently visible ones are evicted first)
+    bool  virtualize_widgets = true;
+    int   max_live_widgets = 64;
+    float widget_min_zoom = 0.4f;
+
+    // nodes and links only get a graphics item inside the viewport
+    // extended by 'virtualization_margin' (fraction of the viewport
+    // size), the others are kept as lightweight records. Below
+    // 'virtualization_lod_zoom' no item is created and the records are
+    // drawn as plain shapes
+    bool  virtualize_items = false;
+    float virtualization_margin = 0.5f;
+    float virtualization_lod_zoom = 0.15f;
+
+    // raster exports (see GraphViewer::export_image) are rendered by
+    // square tiles of 'export_tile_size' pixels
+    int export_tile_size = 1024;
+
+    // released node and link items are kept, up to 'max_pooled_items' of
+    // each, and reused instead of allocating new ones (panning, graph
+    // reloads, connection drags)
+    int max_pooled_items = 1024;
+
+    // commands pushed from other threads (see GraphViewer::push_command)
+    // are applied once per frame, at most 'max_commands_per_frame' of
+    // them (0 for no limit). Beyond 'command_queue_size' waiting
+    // commands, they go through a slower locked overflow list
+    int command_queue_size = 65536;
+    int max_commands_per_frame = 0;
+
+    // compute start and end events kept for the timeline, the oldest ones
+    // are dropped beyond 'compute_event_capacity' (see ComputeEventLog)
+    int compute_event_capacity = 262144;
   } viewer;
 
   struct Node
@@ -55,6 +108,7 @@ public:
     float port_radius_not_selectable = 5.f;
     float vertical_stretching = 1.3f;
     float header_height_scale = 1.2f;
+    float thumbnail_size = 96.f; // port data preview (see ThumbnailCache)
 
     bool reload_button = true;
     bool settings_button = true;
@@ -69,6 +123,24 @@ public:
     QColor color_icon = Qt::lightGray;
     QColor color_comment = QColor(255, 121, 198, 255);
 
+    // compute status strip at the bottom of the header (see ComputeState),
+    // none for the idle and done states
+    float  compute_status_width = 3.f;
+    QColor color_compute_queued = QColor(241, 250, 140, 255);
+    QColor color_compute_running = QColor(255, 184, 108, 255);
+    QColor color_compute_failed = QColor(255, 85, 85, 255);
+    QColor color_compute_cached = QColor(98, 114, 164, 255);
+
+    // compute telemetry overlay (see GraphViewer::set_telemetry_overlay),
+    // the header is colored from 'cold' to 'hot'
+    QColor color_heatmap_cold = QColor(80, 250, 123, 255);
+    QColor color_heatmap_hot = QColor(255, 85, 85, 255);
+    QColor color_heatmap_text = Qt::black;
+
+    // critical path highlight, node border (see
+    // GraphViewer::set_critical_path_visible)
+    QColor color_critical = QColor(255, 85, 85, 255);
+
     QColor color_port_hovered = Qt::white; // QColor(180, 180, 180, 255);
     QColor color_port_selected = QColor(80, 250, 123, 255);
 
@@ -92,6 +164,16 @@ public:
     float  curvature = 0.5f;
     QColor color_default = Qt::lightGray;
     QColor color_selected = QColor(80, 250, 123, 255);
+
+    // critical path highlight (see GraphViewer::set_critical_path_visible)
+    float  pen_width_critical = 3.f;
+    QColor color_critical = QColor(255, 85, 85, 255);
+
+    // dataflow overlay (see GraphViewer::set_dataflow_overlay), strokes from
+    // 'pen_width' to 'pen_width_dataflow_max' and colors from 'low' to 'high'
+    float  pen_width_dataflow_max = 8.f;
+    QColor color_dataflow_low = QColor(98, 114, 164, 255);
+    QColor color_dataflow_high = QColor(255, 184, 108, 255);
   } link;
 
   struct Group
@@ -130,6 +212,25 @@ public:
     float  background_fill_alpha = 0.1f;
   } comment;
 
+  struct Timeline
+  {
+    float lane_height = 18.f;
+    float lane_spacing = 2.f;
+    float concurrency_height = 40.f; // running nodes over time
+    float label_width = 64.f;        // lane captions
+    int   refresh_interval = 250;    // ms, new events polling
+
+    QColor color_bg = QColor(42, 44, 52, 255);
+    QColor color_grid = QColor(68, 71, 90, 255);
+    QColor color_text = Qt::lightGray;
+    QColor color_span = QColor(139, 233, 253, 255);
+    QColor color_span_failed = QColor(255, 85, 85, 255);
+    QColor color_span_cached = QColor(80, 250, 123, 255);
+    QColor color_span_running = QColor(255, 184, 108, 255); // not finished yet
+    QColor color_selected = Qt::white;
+    QColor color_concurrency = QColor(189, 147, 249, 160);
+  } timeline;
+
 private:
   // Disable copy constructor
   Style(const Style &) = delete;
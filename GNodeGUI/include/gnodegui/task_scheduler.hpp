@@ -0,0 +1,104 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file task_scheduler.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Library-wide worker threads for the non-GUI work (serialization, link
+ * paths...), `GN_SCHEDULER`.
+ *
+ * Each worker has its own task queue: tasks submitted from a worker go to its own
+ * queue (most recent first), the other ones are spread over the queues, and idle
+ * workers steal the oldest tasks of the others. Hosts already running a thread pool
+ * can hand the tasks over to it instead (see TaskScheduler::set_executor).
+ *
+ * Tasks must not touch the graphics items nor the scene unless the GUI thread is
+ * waiting for them, as in `parallel_for`.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define GN_SCHEDULER gngui::TaskScheduler::get()
+
+namespace gngui
+{
+
+using Task = std::function<void()>;
+
+// runs the task on a host thread, eventually
+using TaskExecutor = std::function<void(Task task)>;
+
+class TaskScheduler
+{
+public:
+  static TaskScheduler *get();
+
+  ~TaskScheduler();
+
+  // --- Settings
+
+  // applied right away, the tasks already queued are run first (not to be called
+  // from a task). 0 for one per core but one, the thread calling 'parallel_for'
+  // takes part in the work
+  void set_thread_count(int new_thread_count);
+  int  get_thread_count() const;
+
+  // tasks handed over to 'new_executor' instead of the own workers, which are
+  // stopped (same restriction). An empty executor brings them back
+  void set_executor(TaskExecutor new_executor);
+
+  // --- Tasks
+
+  // calls 'fct(k_begin, k_end)' over [begin, end) in ranges of 'grain' indices, on
+  // the workers and the calling thread, and returns once they are all done. 'fct'
+  // must not throw
+  void parallel_for(size_t                                    begin,
+                    size_t                                    end,
+                    const std::function<void(size_t, size_t)> &fct,
+                    size_t                                    grain = 256);
+
+  void submit(Task task); // fire and forget
+
+private:
+  TaskScheduler() = default;
+
+  struct Worker
+  {
+    std::mutex       mutex;
+    std::deque<Task> tasks;
+  };
+
+  // own queue first (most recent), then stolen from the others (oldest)
+  bool pop_task(size_t worker_index, Task &task);
+  void push_task(size_t worker_index, Task task);
+  void run_worker(size_t worker_index);
+  void start(); // no-op if already running
+  void stop();  // after the queued tasks
+
+  // --- Members
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread>             threads;
+  std::mutex                           wake_mutex;
+  std::condition_variable              wake_condition;
+  std::atomic<size_t>                  pending = 0;     // queued tasks
+  std::atomic<size_t>                  next_worker = 0; // external submissions
+  bool                                 is_stopping = false;
+
+  std::mutex       settings_mutex;
+  TaskExecutor     executor;
+  std::atomic<int> thread_count = 0; // also read by 'parallel_for', unlocked
+};
+
+} // namespace gngui
@@ -0,0 +1,135 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+
+/**
+ * @file thumbnail_cache.hpp
+ * @author Otto Link (otto.link.bv@gmail.com)
+ * @brief Asynchronous generation and caching of port data thumbnails.
+ *
+ * Hosts register a converter per port data type (the `NodeProxy::get_data_type`
+ * string). Converters are called on the GUI thread with the opaque port data
+ * (`NodeProxy::get_data_ref`), which is only guaranteed to be valid during that call:
+ * they copy what they need out of it and return a job turning the copy into a small
+ * image. Jobs are run by the library task scheduler (see GN_SCHEDULER). Results are
+ * kept in a memory-budgeted LRU cache keyed by node, port and data version.
+ *
+ * @copyright Copyright (c) 2024 Otto Link. Distributed under the terms of the
+ * GNU General Public License. See the file LICENSE for the full license.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+
+namespace gngui
+{
+
+// run on a worker thread, owns everything it reads
+using ThumbnailJob = std::function<QImage()>;
+
+// run on the GUI thread, 'p_data' is not to be kept. An empty job for no thumbnail
+using ThumbnailConverter = std::function<ThumbnailJob(void *p_data, QSize size)>;
+
+class ThumbnailCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ThumbnailCache(QObject *parent = nullptr);
+  ~ThumbnailCache();
+
+  // --- Converters
+
+  bool has_converter(const std::string &data_type) const;
+  void set_converter(const std::string &data_type, ThumbnailConverter converter);
+
+  // --- Cache
+
+  void clear();
+  void remove_node(const std::string &node_id);
+
+  // returns the cached thumbnail, possibly from an older data version, or nullptr. If
+  // the cached version is missing or outdated, a conversion is scheduled and
+  // 'thumbnail_ready' is emitted once it is available. Conversions of removed nodes
+  // are cancelled, or their result dropped if already running. A version without
+  // thumbnail (empty job, image over the memory budget) is not converted again, an
+  // evicted one not before a short delay
+  const QImage *get(const std::string &node_id,
+                    int                port_index,
+                    uint64_t           version,
+                    const std::string &data_type,
+                    void              *p_data,
+                    QSize              size);
+
+  // --- Settings
+
+  void   set_memory_budget(size_t new_memory_budget); // in bytes
+  size_t get_memory_usage() const { return this->memory_usage; }
+
+  // up-to-date / missing or outdated thumbnail requests, since the creation
+  uint64_t get_hit_count() const { return this->hit_count; }
+  uint64_t get_miss_count() const { return this->miss_count; }
+
+Q_SIGNALS:
+  void thumbnail_ready(const std::string &node_id, int port_index);
+
+private:
+  using Key = std::pair<std::string, int>; // (node id, port index)
+
+  struct Entry
+  {
+    uint64_t                 version;
+    QImage                   image;
+    std::list<Key>::iterator lru_it;
+  };
+
+  struct Request
+  {
+    uint64_t                           ticket; // tells apart re-requests of a key
+    std::shared_ptr<std::atomic<bool>> is_cancelled;
+  };
+
+  // shared with the running jobs, which deliver their result only while the cache
+  // is alive
+  struct Delivery
+  {
+    std::mutex      mutex;
+    ThumbnailCache *p_cache;
+  };
+
+  void cancel_pending(const std::function<bool(const Key &)> &predicate);
+  void evict(bool keep_most_recent); // down to the memory budget
+  bool is_skipped(const Key &key, uint64_t version) const;
+  void insert(const Key &key, uint64_t version, uint64_t ticket, const QImage &image);
+
+  // --- Members
+
+  std::map<std::string, ThumbnailConverter>   converters;
+  std::map<Key, Entry>                        entries;
+  std::list<Key>                              lru;     // most recently used first
+  std::map<std::pair<Key, uint64_t>, Request> pending; // by (key, version)
+  uint64_t                                    next_ticket = 0;
+  size_t                                      memory_budget = 64 * 1024 * 1024;
+  size_t                                      memory_usage = 0;
+  uint64_t                                    hit_count = 0;
+  uint64_t                                    miss_count = 0;
+  std::shared_ptr<Delivery>                   delivery;
+
+  // conversion requests not to be repeated: versions without thumbnail, and
+  // (version, time) of the evicted ones
+  std::map<Key, uint64_t>                    skipped_versions;
+  std::map<Key, std::pair<uint64_t, qint64>> evicted_versions;
+  QElapsedTimer                              clock; // eviction times, in ms
+};
+
+} // namespace gngui
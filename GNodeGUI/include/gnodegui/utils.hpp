@@ -14,6 +14,8 @@
 #include <vector>
 
 #include <QGraphicsItem>
+#include <QGraphicsView>
+#include <QPainter>
 #include <QRectF>
 
 namespace gngui
@@ -21,6 +23,16 @@ namespace gngui
 
 void   clean_delete_graphics_item(QGraphicsItem *item);
 QRectF compute_bounding_rect(const std::vector<QGraphicsItem *> &items);
+bool   is_draft_render(const QWidget *widget); // 'widget' as given to paint
+
+// all the items of the scene, counted as a scene scan (see RuntimeCounters)
+QList<QGraphicsItem *> get_scene_items(const QGraphicsScene *scene);
+
+// overlay items (viewer toolbar...) belong to a single view of a possibly shared
+// scene, they are neither drawn nor hit in the other views
+bool is_overlay_drawn_in(const QGraphicsItem *item, const QWidget *widget);
+bool is_overlay_item(const QGraphicsItem *item);
+void set_overlay_view(QGraphicsItem *item, const QGraphicsView *view);
 
 std::vector<std::string> split_string(const std::string &string, char delimiter);
 
@@ -0,0 +1,40 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <algorithm>
+
+#include "gnodegui/compute_events.hpp"
+
+namespace gngui
+{
+
+ComputeEventLog::ComputeEventLog(size_t capacity)
+    : events(std::max(capacity, size_t(1)))
+{
+}
+
+const ComputeEvent &ComputeEventLog::at(size_t index) const
+{
+  const uint64_t first = this->count - this->size();
+  return this->events[(first + index) % this->events.size()];
+}
+
+void ComputeEventLog::clear()
+{
+  // the revision keeps increasing, readers still notice the change
+  this->count_at_clear = ++this->count;
+}
+
+void ComputeEventLog::push(const ComputeEvent &event)
+{
+  this->events[this->count % this->events.size()] = event;
+  this->count++;
+}
+
+size_t ComputeEventLog::size() const
+{
+  return (size_t)std::min(this->count - this->count_at_clear,
+                          (uint64_t)this->events.size());
+}
+
+} // namespace gngui
@@ -0,0 +1,653 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QWheelEvent>
+
+#include "gnodegui/compute_timeline.hpp"
+#include "gnodegui/logger.hpp"
+#include "gnodegui/style.hpp"
+
+namespace gngui
+{
+
+static QString format_time(double ns)
+{
+  if (std::abs(ns) < 1e3)
+    return QString::number(ns, 'g', 4) + " ns";
+  else if (std::abs(ns) < 1e6)
+    return QString::number(1e-3 * ns, 'g', 4) + " us";
+  else if (std::abs(ns) < 1e9)
+    return QString::number(1e-6 * ns, 'g', 4) + " ms";
+  else
+    return QString::number(1e-9 * ns, 'g', 4) + " s";
+}
+
+static QColor get_span_color(ComputeState state)
+{
+  switch (state)
+  {
+  case ComputeState::RUNNING:
+    return GN_STYLE->timeline.color_span_running;
+
+  case ComputeState::FAILED:
+    return GN_STYLE->timeline.color_span_failed;
+
+  case ComputeState::CACHED:
+    return GN_STYLE->timeline.color_span_cached;
+
+  default:
+    return GN_STYLE->timeline.color_span;
+  }
+}
+
+ComputeTimeline::ComputeTimeline(GraphViewer *p_viewer, QWidget *parent)
+    : QWidget(parent), p_viewer(p_viewer)
+{
+  this->setMinimumHeight(this->get_axis_height() +
+                         (int)GN_STYLE->timeline.concurrency_height +
+                         (int)GN_STYLE->timeline.lane_height);
+
+  this->connect(&this->refresh_timer,
+                &QTimer::timeout,
+                this,
+                &ComputeTimeline::refresh);
+
+  this->refresh_timer.start(GN_STYLE->timeline.refresh_interval);
+}
+
+void ComputeTimeline::draw_axis(QPainter &painter)
+{
+  const float label_width = GN_STYLE->timeline.label_width;
+  const int   axis_height = this->get_axis_height();
+
+  painter.setClipping(false);
+  painter.fillRect(QRectF(0, 0, this->width(), axis_height),
+                   GN_STYLE->timeline.color_bg);
+
+  // ticks every 1, 2 or 5 powers of ten, at least 'min_spacing' pixels apart
+  const double min_spacing = 100.0;
+  const double raw_step = min_spacing * this->ns_per_pixel;
+  const double pow10 = std::pow(10.0, std::floor(std::log10(raw_step)));
+  double       step = 10.0 * pow10;
+
+  for (double k : {1.0, 2.0, 5.0})
+    if (k * pow10 >= raw_step)
+    {
+      step = k * pow10;
+      break;
+    }
+
+  const double t_start = std::ceil(this->time_origin / step) * step;
+  const double t_end = this->time_origin +
+                       (this->width() - label_width) * this->ns_per_pixel;
+
+  for (double t = t_start; t <= t_end; t += step)
+  {
+    const double x = label_width + (t - this->time_origin) / this->ns_per_pixel;
+
+    painter.setPen(GN_STYLE->timeline.color_grid);
+    painter.drawLine(QPointF(x, axis_height - 4), QPointF(x, this->height()));
+
+    painter.setPen(GN_STYLE->timeline.color_text);
+    painter.drawText(QPointF(x + 3, axis_height - 5), format_time(t));
+  }
+
+  painter.setPen(GN_STYLE->timeline.color_grid);
+  painter.drawLine(QPointF(label_width, 0), QPointF(label_width, this->height()));
+}
+
+void ComputeTimeline::draw_concurrency(QPainter &painter)
+{
+  const float  label_width = GN_STYLE->timeline.label_width;
+  const double top = this->get_axis_height();
+  const double height = GN_STYLE->timeline.concurrency_height;
+
+  painter.setClipping(false);
+  painter.fillRect(QRectF(0, top, this->width(), height), GN_STYLE->timeline.color_bg);
+
+  painter.setPen(GN_STYLE->timeline.color_text);
+  painter.drawText(QRectF(4, top, label_width - 8, height),
+                   Qt::AlignVCenter | Qt::AlignLeft,
+                   QString("max %1").arg(this->max_concurrency));
+
+  if (this->concurrency.empty() || this->max_concurrency == 0)
+    return;
+
+  // one bar per pixel column, for the most nodes running during its time interval
+  const QColor color = GN_STYLE->timeline.color_concurrency;
+  const int    x_start = (int)label_width;
+
+  auto it = std::upper_bound(this->concurrency.begin(),
+                             this->concurrency.end(),
+                             this->get_time(x_start),
+                             [](int64_t t, const std::pair<int64_t, int> &step)
+                             { return t < step.first; });
+
+  int current = it == this->concurrency.begin() ? 0 : std::prev(it)->second;
+
+  for (int x = x_start; x < this->width(); x++)
+  {
+    const int64_t t_next = this->get_time(x + 1);
+    int           peak = current;
+
+    for (; it != this->concurrency.end() && it->first < t_next; ++it)
+    {
+      current = it->second;
+      peak = std::max(peak, current);
+    }
+
+    if (peak > 0)
+    {
+      const double bar = height * peak / this->max_concurrency;
+      painter.fillRect(QRectF(x, top + height - bar, 1.0, bar), color);
+    }
+  }
+}
+
+void ComputeTimeline::draw_lanes(QPainter &painter)
+{
+  const float  label_width = GN_STYLE->timeline.label_width;
+  const float  lane_height = GN_STYLE->timeline.lane_height;
+  const double lane_step = lane_height + GN_STYLE->timeline.lane_spacing;
+  const int    top = this->get_axis_height() +
+                  (int)GN_STYLE->timeline.concurrency_height;
+  const int    lanes_top = this->get_lanes_top();
+
+  const int64_t t_view_start = this->get_time(label_width);
+  const int64_t t_view_end = this->get_time(this->width());
+
+  const QFontMetrics font_metrics = painter.fontMetrics();
+
+  for (size_t k = 0; k < this->lanes.size(); k++)
+  {
+    const double y = lanes_top + k * lane_step;
+
+    if (y + lane_height < top)
+      continue;
+    if (y > this->height())
+      break;
+
+    const Lane &lane = this->lanes[k];
+
+    // caption
+    painter.setClipRect(QRect(0, top, (int)label_width, this->height() - top));
+    painter.setPen(GN_STYLE->timeline.color_text);
+    painter.drawText(QRectF(4, y, label_width - 8, lane_height),
+                     Qt::AlignVCenter | Qt::AlignLeft,
+                     lane.caption);
+
+    // spans, the first visible one started at most 'max_duration' before the view
+    painter.setClipRect(QRect((int)label_width,
+                              top,
+                              this->width() - (int)label_width,
+                              this->height() - top));
+
+    auto it = std::lower_bound(lane.spans.begin(),
+                               lane.spans.end(),
+                               t_view_start - lane.max_duration,
+                               [](const Span &span, int64_t t) { return span.t0 < t; });
+
+    QRectF merged; // spans narrower than a pixel, drawn as a single rectangle
+
+    for (; it != lane.spans.end() && it->t0 <= t_view_end; ++it)
+    {
+      if (it->t1 < t_view_start)
+        continue;
+
+      const double x0 = this->get_x(it->t0);
+      const double x1 = this->get_x(it->t1);
+      const bool   is_selected = it->handle == this->selected_handle;
+
+      if (x1 - x0 < 1.0 && !is_selected)
+      {
+        if (!merged.isNull() && x0 <= merged.right() + 1.0)
+        {
+          merged.setRight(std::max(merged.right(), x0 + 1.0));
+          continue;
+        }
+
+        if (!merged.isNull())
+          painter.fillRect(merged, GN_STYLE->timeline.color_span);
+
+        merged = QRectF(x0, y, 1.0, lane_height);
+        continue;
+      }
+
+      const QRectF rect(x0, y, std::max(1.0, x1 - x0), lane_height);
+
+      painter.fillRect(rect, get_span_color(it->state));
+
+      if (is_selected)
+      {
+        painter.setPen(QPen(GN_STYLE->timeline.color_selected, 2.0));
+        painter.drawRect(rect);
+      }
+
+      // node caption if there is room enough
+      if (this->p_viewer && rect.width() > 3 * font_metrics.averageCharWidth())
+      {
+        const QString caption = font_metrics.elidedText(
+            QString::fromStdString(this->p_viewer->get_node_id(it->handle)),
+            Qt::ElideRight,
+            (int)rect.width() - 4);
+
+        painter.setPen(GN_STYLE->timeline.color_bg);
+        painter.drawText(rect.adjusted(2, 0, -2, 0), Qt::AlignVCenter, caption);
+      }
+    }
+
+    if (!merged.isNull())
+      painter.fillRect(merged, GN_STYLE->timeline.color_span);
+  }
+}
+
+bool ComputeTimeline::event(QEvent *event)
+{
+  if (event->type() == QEvent::ToolTip)
+  {
+    QHelpEvent *help_event = static_cast<QHelpEvent *>(event);
+    const Span *p_span = this->get_span_at(help_event->pos());
+
+    if (p_span && this->p_viewer)
+    {
+      QString text = QString::fromStdString(this->p_viewer->get_node_id(p_span->handle));
+
+      text += "\n" + format_time(double(p_span->t1 - p_span->t0));
+
+      if (p_span->state == ComputeState::RUNNING)
+        text += " (running)";
+      else if (p_span->state == ComputeState::FAILED)
+        text += " (failed)";
+      else if (p_span->state == ComputeState::CACHED)
+        text += " (cached)";
+
+      QToolTip::showText(help_event->globalPos(), text, this);
+    }
+    else
+    {
+      QToolTip::hideText();
+      event->ignore();
+    }
+
+    return true;
+  }
+
+  return QWidget::event(event);
+}
+
+void ComputeTimeline::fit()
+{
+  const double width = std::max(1.0,
+                                double(this->width() - GN_STYLE->timeline.label_width));
+  const double range = std::max(1e3, double(this->time_max - this->time_min));
+
+  // small margin on the right, the last span is not stuck to the border
+  this->ns_per_pixel = 1.02 * range / width;
+  this->time_origin = 0.0;
+  this->is_fitted = true;
+
+  this->update();
+}
+
+int ComputeTimeline::get_axis_height() const { return this->fontMetrics().height() + 6; }
+
+int ComputeTimeline::get_lanes_top() const
+{
+  return this->get_axis_height() + (int)GN_STYLE->timeline.concurrency_height +
+         (int)GN_STYLE->timeline.lane_spacing - this->scroll_y;
+}
+
+int ComputeTimeline::get_max_scroll() const
+{
+  const double lane_step = GN_STYLE->timeline.lane_height +
+                           GN_STYLE->timeline.lane_spacing;
+  const int    lanes_height = (int)std::ceil(this->lanes.size() * lane_step);
+
+  return std::max(0,
+                  lanes_height - this->height() + this->get_lanes_top() +
+                      this->scroll_y);
+}
+
+const ComputeTimeline::Span *ComputeTimeline::get_span_at(QPoint pos) const
+{
+  const float  label_width = GN_STYLE->timeline.label_width;
+  const float  lane_height = GN_STYLE->timeline.lane_height;
+  const double lane_step = lane_height + GN_STYLE->timeline.lane_spacing;
+  const int    top = this->get_axis_height() +
+                  (int)GN_STYLE->timeline.concurrency_height;
+
+  if (pos.x() < label_width || pos.y() < top)
+    return nullptr;
+
+  const double y = pos.y() - this->get_lanes_top();
+  const int    k = (int)std::floor(y / lane_step);
+
+  if (y < 0.0 || k >= (int)this->lanes.size() || y - k * lane_step > lane_height)
+    return nullptr;
+
+  // a few pixels of tolerance, for the spans narrower than a pixel
+  const Lane   &lane = this->lanes[k];
+  const int64_t t = this->get_time(pos.x());
+  const int64_t dt = (int64_t)(3.0 * this->ns_per_pixel);
+
+  auto it = std::lower_bound(lane.spans.begin(),
+                             lane.spans.end(),
+                             t - dt - lane.max_duration,
+                             [](const Span &span, int64_t t) { return span.t0 < t; });
+
+  const Span *p_nearest = nullptr;
+  int64_t     nearest_distance = dt + 1;
+
+  for (; it != lane.spans.end() && it->t0 <= t + dt; ++it)
+  {
+    const int64_t distance = t < it->t0 ? it->t0 - t : (t > it->t1 ? t - it->t1 : 0);
+
+    if (distance < nearest_distance)
+    {
+      p_nearest = &*it;
+      nearest_distance = distance;
+    }
+  }
+
+  return p_nearest;
+}
+
+int64_t ComputeTimeline::get_time(double x) const
+{
+  return this->time_min +
+         (int64_t)(this->time_origin +
+                   (x - GN_STYLE->timeline.label_width) * this->ns_per_pixel);
+}
+
+double ComputeTimeline::get_x(int64_t time) const
+{
+  return GN_STYLE->timeline.label_width +
+         (double(time - this->time_min) - this->time_origin) / this->ns_per_pixel;
+}
+
+void ComputeTimeline::mouseDoubleClickEvent(QMouseEvent *event)
+{
+  if (event->button() == Qt::LeftButton)
+    this->fit();
+
+  QWidget::mouseDoubleClickEvent(event);
+}
+
+void ComputeTimeline::mouseMoveEvent(QMouseEvent *event)
+{
+  if (this->is_dragging)
+  {
+    const QPoint delta = event->pos() - this->drag_pos;
+
+    if (!this->has_dragged && delta.manhattanLength() < 4)
+      return;
+
+    this->has_dragged = true;
+    this->drag_pos = event->pos();
+
+    this->time_origin -= delta.x() * this->ns_per_pixel;
+    this->scroll_y = std::clamp(this->scroll_y - delta.y(), 0, this->get_max_scroll());
+    this->is_fitted = false;
+    this->update();
+  }
+
+  QWidget::mouseMoveEvent(event);
+}
+
+void ComputeTimeline::mousePressEvent(QMouseEvent *event)
+{
+  if (event->button() == Qt::LeftButton)
+  {
+    this->is_dragging = true;
+    this->has_dragged = false;
+    this->drag_pos = event->pos();
+  }
+
+  QWidget::mousePressEvent(event);
+}
+
+void ComputeTimeline::mouseReleaseEvent(QMouseEvent *event)
+{
+  if (event->button() == Qt::LeftButton && this->is_dragging)
+  {
+    this->is_dragging = false;
+
+    // click without drag, the node of the span is selected in the viewer
+    if (!this->has_dragged)
+    {
+      const Span *p_span = this->get_span_at(event->pos());
+
+      this->selected_handle = p_span ? p_span->handle : NULL_NODE_HANDLE;
+
+      if (p_span && this->p_viewer)
+      {
+        this->p_viewer->deselect_all();
+        this->p_viewer->set_node_as_selected(p_span->handle);
+      }
+
+      this->update();
+    }
+  }
+
+  QWidget::mouseReleaseEvent(event);
+}
+
+void ComputeTimeline::paintEvent(QPaintEvent * /* event */)
+{
+  QPainter painter(this);
+
+  painter.fillRect(this->rect(), GN_STYLE->timeline.color_bg);
+
+  this->draw_axis(painter);
+  this->draw_concurrency(painter);
+  this->draw_lanes(painter);
+}
+
+void ComputeTimeline::rebuild()
+{
+  this->lanes.clear();
+  this->concurrency.clear();
+  this->max_concurrency = 0;
+
+  if (!this->p_viewer)
+    return;
+
+  const ComputeEventLog &log = this->p_viewer->get_compute_events();
+
+  this->revision = log.get_revision();
+
+  if (log.size() == 0)
+  {
+    this->time_min = 0;
+    this->time_max = 0;
+    return;
+  }
+
+  // pair the starts and ends of each node, per thread (sorted, thread id 0 for the
+  // runs without thread id, first). Ends whose start was dropped from the log are
+  // ignored
+  struct Run
+  {
+    int64_t  t0;
+    uint32_t thread_id;
+  };
+
+  std::unordered_map<NodeHandle, Run>   running;
+  std::map<uint32_t, std::vector<Span>> thread_spans;
+
+  this->time_min = log.at(0).time;
+  this->time_max = log.at(0).time;
+
+  for (size_t k = 0; k < log.size(); k++)
+  {
+    const ComputeEvent &event = log.at(k);
+
+    // host times are not necessarily ordered between threads
+    this->time_min = std::min(this->time_min, event.time);
+    this->time_max = std::max(this->time_max, event.time);
+
+    if (event.state == ComputeState::RUNNING)
+    {
+      running[event.handle] = {event.time, event.thread_id};
+      continue;
+    }
+
+    auto it = running.find(event.handle);
+
+    if (it == running.end())
+      continue;
+
+    const Run &run = it->second;
+
+    thread_spans[run.thread_id].push_back(
+        {run.t0, std::max(run.t0, event.time), event.handle, event.state});
+    running.erase(it);
+  }
+
+  for (auto &[handle, run] : running)
+    thread_spans[run.thread_id].push_back(
+        {run.t0, this->time_max, handle, ComputeState::RUNNING});
+
+  // lanes
+  for (auto &[thread_id, spans] : thread_spans)
+  {
+    std::sort(spans.begin(),
+              spans.end(),
+              [](const Span &a, const Span &b) { return a.t0 < b.t0; });
+
+    if (thread_id != 0)
+    {
+      this->lanes.push_back({QString("T%1").arg(thread_id), std::move(spans)});
+      continue;
+    }
+
+    // no thread, the runs are packed in the first lane free at their start
+    const size_t         first_lane = this->lanes.size();
+    std::vector<int64_t> lane_ends;
+
+    for (const Span &span : spans)
+    {
+      size_t k = 0;
+
+      while (k < lane_ends.size() && lane_ends[k] > span.t0)
+        k++;
+
+      if (k == lane_ends.size())
+      {
+        lane_ends.push_back(0);
+        this->lanes.push_back({QString("#%1").arg(k + 1), {}});
+      }
+
+      this->lanes[first_lane + k].spans.push_back(span);
+      lane_ends[k] = span.t1;
+    }
+  }
+
+  // concurrency steps, ends before starts at the same time
+  std::vector<std::pair<int64_t, int>> deltas;
+
+  for (Lane &lane : this->lanes)
+    for (const Span &span : lane.spans)
+    {
+      lane.max_duration = std::max(lane.max_duration, span.t1 - span.t0);
+      deltas.push_back({span.t0, 1});
+      deltas.push_back({span.t1, -1});
+    }
+
+  std::sort(deltas.begin(), deltas.end());
+
+  int count = 0;
+
+  for (auto &[time, delta] : deltas)
+  {
+    count += delta;
+    this->max_concurrency = std::max(this->max_concurrency, count);
+
+    if (!this->concurrency.empty() && this->concurrency.back().first == time)
+      this->concurrency.back().second = count;
+    else
+      this->concurrency.push_back({time, count});
+  }
+
+  this->scroll_y = std::clamp(this->scroll_y, 0, this->get_max_scroll());
+
+  Logger::log()->trace("ComputeTimeline::rebuild: {} event(s), {} lane(s)",
+                       log.size(),
+                       this->lanes.size());
+}
+
+void ComputeTimeline::refresh()
+{
+  if (!this->isVisible() || !this->p_viewer)
+    return;
+
+  if (this->p_viewer->get_compute_events().get_revision() == this->revision)
+    return;
+
+  // the view keeps its absolute time position, 'time_min' may change
+  const int64_t view_start = this->get_time(GN_STYLE->timeline.label_width);
+
+  this->rebuild();
+
+  if (this->is_fitted)
+    this->fit();
+  else
+    this->time_origin = double(view_start - this->time_min);
+
+  this->update();
+}
+
+void ComputeTimeline::resizeEvent(QResizeEvent *event)
+{
+  QWidget::resizeEvent(event);
+
+  if (this->is_fitted)
+    this->fit();
+
+  this->scroll_y = std::clamp(this->scroll_y, 0, this->get_max_scroll());
+}
+
+void ComputeTimeline::wheelEvent(QWheelEvent *event)
+{
+  const double steps = event->angleDelta().y() / 120.0;
+
+  // shift for the lanes scrolling, zoom otherwise
+  if (event->modifiers() & Qt::ShiftModifier)
+  {
+    const int lane_step = (int)(GN_STYLE->timeline.lane_height +
+                                GN_STYLE->timeline.lane_spacing);
+
+    this->scroll_y = std::clamp(this->scroll_y - (int)(steps * lane_step),
+                                0,
+                                this->get_max_scroll());
+    this->update();
+  }
+  else
+    this->zoom(std::pow(1.2, steps), event->position().x());
+
+  event->accept();
+}
+
+void ComputeTimeline::zoom(double factor, double anchor_x)
+{
+  // the time under 'anchor_x' stays in place
+  const double offset = std::max(0.0, anchor_x - GN_STYLE->timeline.label_width);
+  const double t_anchor = this->time_origin + offset * this->ns_per_pixel;
+
+  this->ns_per_pixel = std::clamp(this->ns_per_pixel / factor, 1e-2, 1e12);
+  this->time_origin = t_anchor - offset * this->ns_per_pixel;
+  this->is_fitted = false;
+
+  this->update();
+}
+
+} // namespace gngui
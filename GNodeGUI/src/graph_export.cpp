@@ -0,0 +1,295 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <QFileInfo>
+
+#include "nlohmann/json.hpp"
+
+#include "gnodegui/graph_export.hpp"
+
+namespace gngui
+{
+
+// --- Helpers
+
+static std::string get_port_id(const NodeRecord *p_record, int port_index)
+{
+  return p_record->p_proxy ? p_record->p_proxy->get_port_id(port_index)
+                           : std::to_string(port_index);
+}
+
+static std::string get_link_data_type(const LinkRecord &record)
+{
+  return record.node_out->p_proxy
+             ? record.node_out->p_proxy->get_data_type(record.port_out)
+             : "";
+}
+
+static std::string dot_escape(const std::string &str, bool is_record_field = false)
+{
+  std::string escaped;
+  escaped.reserve(str.size());
+
+  for (char c : str)
+  {
+    const bool is_special = c == '"' || c == '\\' ||
+                            (is_record_field && (c == '{' || c == '}' || c == '|' ||
+                                                 c == '<' || c == '>' || c == ' '));
+    if (is_special)
+      escaped.push_back('\\');
+    escaped.push_back(c);
+  }
+
+  return escaped;
+}
+
+static std::string xml_escape(const std::string &str)
+{
+  std::string escaped;
+  escaped.reserve(str.size());
+
+  for (char c : str)
+    switch (c)
+    {
+    case '&':
+      escaped += "&amp;";
+      break;
+    case '<':
+      escaped += "&lt;";
+      break;
+    case '>':
+      escaped += "&gt;";
+      break;
+    case '"':
+      escaped += "&quot;";
+      break;
+    case '\'':
+      escaped += "&apos;";
+      break;
+    default:
+      escaped.push_back(c);
+    }
+
+  return escaped;
+}
+
+// --- Graphviz DOT
+
+class DotWriter : public GraphWriter
+{
+public:
+  using GraphWriter::GraphWriter;
+
+  void begin(const std::string &graph_id) override
+  {
+    this->out << "digraph \"" << dot_escape(graph_id) << "\" {\n"
+              << "label=\"" << dot_escape(graph_id) << "\";\n"
+              << "labelloc=\"t\";\n"
+              << "rankdir=TD;\n"
+              << "ranksep=0.5;\n"
+              << "node [shape=record];\n"
+              << "edge [fontsize=8];\n";
+  }
+
+  void write_node(const NodeRecord &record, QPointF pos) override
+  {
+    // record shape: inputs on top, caption, outputs at the bottom. Port
+    // fields are named after their index, the links refer to them
+    std::string ins, outs;
+
+    if (record.p_proxy)
+      for (int k = 0; k < record.p_proxy->get_nports(); k++)
+      {
+        std::string &fields = record.p_proxy->get_port_type(k) == PortType::IN ? ins
+                                                                               : outs;
+        if (!fields.empty())
+          fields += "|";
+        fields += "<p" + std::to_string(k) + ">" +
+                  dot_escape(record.p_proxy->get_port_caption(k), true);
+      }
+
+    const std::string caption = record.p_proxy ? record.p_proxy->get_caption() : "";
+
+    this->out << "\"" << dot_escape(record.id) << "\" [label=\"{";
+    if (!ins.empty())
+      this->out << "{" << ins << "}|";
+    this->out << dot_escape(caption + " (" + record.id + ")", true);
+    if (!outs.empty())
+      this->out << "|{" << outs << "}";
+
+    // y axis pointing up in Graphviz
+    this->out << "}\", pos=\"" << pos.x() << "," << -pos.y() << "!\"];\n";
+  }
+
+  void write_link(const LinkRecord &record) override
+  {
+    this->out << "\"" << dot_escape(record.node_out->id) << "\":p" << record.port_out
+              << " -> \"" << dot_escape(record.node_in->id) << "\":p" << record.port_in
+              << " [label=\"" << dot_escape(get_link_data_type(record)) << "\"];\n";
+  }
+
+  void end() override { this->out << "}\n"; }
+};
+
+// --- GraphML
+
+class GraphMLWriter : public GraphWriter
+{
+public:
+  using GraphWriter::GraphWriter;
+
+  void begin(const std::string &graph_id) override
+  {
+    this->out
+        << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+        << "<key id=\"caption\" for=\"all\" attr.name=\"caption\" "
+           "attr.type=\"string\"/>\n"
+        << "<key id=\"category\" for=\"node\" attr.name=\"category\" "
+           "attr.type=\"string\"/>\n"
+        << "<key id=\"x\" for=\"node\" attr.name=\"x\" attr.type=\"double\"/>\n"
+        << "<key id=\"y\" for=\"node\" attr.name=\"y\" attr.type=\"double\"/>\n"
+        << "<key id=\"port_type\" for=\"port\" attr.name=\"port_type\" "
+           "attr.type=\"string\"/>\n"
+        << "<key id=\"data_type\" for=\"all\" attr.name=\"data_type\" "
+           "attr.type=\"string\"/>\n"
+        << "<graph id=\"" << xml_escape(graph_id) << "\" edgedefault=\"directed\">\n";
+  }
+
+  void write_node(const NodeRecord &record, QPointF pos) override
+  {
+    this->out << "<node id=\"" << xml_escape(record.id) << "\">";
+
+    if (record.p_proxy)
+    {
+      this->write_data("caption", record.p_proxy->get_caption());
+      this->write_data("category", record.p_proxy->get_category());
+    }
+
+    this->out << "<data key=\"x\">" << pos.x() << "</data>"
+              << "<data key=\"y\">" << pos.y() << "</data>";
+
+    if (record.p_proxy)
+      for (int k = 0; k < record.p_proxy->get_nports(); k++)
+      {
+        const bool is_in = record.p_proxy->get_port_type(k) == PortType::IN;
+
+        this->out << "\n  <port name=\"" << xml_escape(get_port_id(&record, k))
+                  << "\">";
+        this->write_data("caption", record.p_proxy->get_port_caption(k));
+        this->write_data("port_type", is_in ? "in" : "out");
+        this->write_data("data_type", record.p_proxy->get_data_type(k));
+        this->out << "</port>";
+      }
+
+    this->out << "</node>\n";
+  }
+
+  void write_link(const LinkRecord &record) override
+  {
+    this->out << "<edge source=\"" << xml_escape(record.node_out->id)
+              << "\" sourceport=\""
+              << xml_escape(get_port_id(record.node_out, record.port_out))
+              << "\" target=\"" << xml_escape(record.node_in->id)
+              << "\" targetport=\""
+              << xml_escape(get_port_id(record.node_in, record.port_in)) << "\">";
+    this->write_data("data_type", get_link_data_type(record));
+    this->out << "</edge>\n";
+  }
+
+  void end() override { this->out << "</graph>\n</graphml>\n"; }
+
+private:
+  void write_data(const char *key, const std::string &value)
+  {
+    this->out << "<data key=\"" << key << "\">" << xml_escape(value) << "</data>";
+  }
+};
+
+// --- JSON Lines
+
+class JsonLinesWriter : public GraphWriter
+{
+public:
+  using GraphWriter::GraphWriter;
+
+  void begin(const std::string &graph_id) override
+  {
+    this->write_line({{"type", "graph"}, {"id", graph_id}});
+  }
+
+  void write_node(const NodeRecord &record, QPointF pos) override
+  {
+    nlohmann::json json = {{"type", "node"},
+                           {"id", record.id},
+                           {"x", pos.x()},
+                           {"y", pos.y()}};
+
+    if (record.p_proxy)
+    {
+      json["caption"] = record.p_proxy->get_caption();
+      json["category"] = record.p_proxy->get_category();
+
+      nlohmann::json json_ports = nlohmann::json::array();
+
+      for (int k = 0; k < record.p_proxy->get_nports(); k++)
+      {
+        const bool is_in = record.p_proxy->get_port_type(k) == PortType::IN;
+
+        json_ports.push_back({{"id", get_port_id(&record, k)},
+                              {"caption", record.p_proxy->get_port_caption(k)},
+                              {"port_type", is_in ? "in" : "out"},
+                              {"data_type", record.p_proxy->get_data_type(k)}});
+      }
+
+      json["ports"] = json_ports;
+    }
+
+    this->write_line(json);
+  }
+
+  void write_link(const LinkRecord &record) override
+  {
+    this->write_line({{"type", "link"},
+                      {"node_out_id", record.node_out->id},
+                      {"port_out_id", get_port_id(record.node_out, record.port_out)},
+                      {"node_in_id", record.node_in->id},
+                      {"port_in_id", get_port_id(record.node_in, record.port_in)},
+                      {"data_type", get_link_data_type(record)}});
+  }
+
+  void end() override {}
+
+private:
+  void write_line(const nlohmann::json &json) { this->out << json.dump() << '\n'; }
+};
+
+// --- Functions
+
+GraphExportFormat graph_export_format_from_fname(const std::string &fname)
+{
+  const QString suffix = QFileInfo(fname.c_str()).suffix().toLower();
+
+  if (suffix == "graphml")
+    return GraphExportFormat::GRAPHML;
+  else if (suffix == "jsonl" || suffix == "ndjson")
+    return GraphExportFormat::JSONL;
+
+  return GraphExportFormat::DOT;
+}
+
+std::unique_ptr<GraphWriter> make_graph_writer(GraphExportFormat format,
+                                               std::ostream     &out)
+{
+  switch (format)
+  {
+  case GraphExportFormat::GRAPHML:
+    return std::make_unique<GraphMLWriter>(out);
+  case GraphExportFormat::JSONL:
+    return std::make_unique<JsonLinesWriter>(out);
+  default:
+    return std::make_unique<DotWriter>(out);
+  }
+}
+
+} // namespace gngui
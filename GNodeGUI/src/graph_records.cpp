@@ -0,0 +1,230 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include "gnodegui/graph_records.hpp"
+#include "gnodegui/logger.hpp"
+#include "gnodegui/style.hpp"
+#include "gnodegui/utils.hpp"
+
+namespace gngui
+{
+
+// --- NodeRecord
+
+int NodeRecord::get_port_index(const std::string &port_id) const
+{
+  if (this->p_proxy)
+    for (int k = 0; k < this->p_proxy->get_nports(); k++)
+      if (this->p_proxy->get_port_id(k) == port_id)
+        return k;
+
+  return -1;
+}
+
+void NodeRecord::json_from(const nlohmann::json &json)
+{
+  json_safe_get(json, "is_widget_visible", this->is_widget_visible);
+
+  float x = 0;
+  float y = 0;
+  json_safe_get(json, "scene_position.x", x);
+  json_safe_get(json, "scene_position.y", y);
+  this->pos = QPointF(x, y);
+}
+
+nlohmann::json NodeRecord::json_to() const
+{
+  nlohmann::json json;
+
+  json["is_widget_visible"] = this->is_widget_visible;
+  json["scene_position.x"] = this->pos.x();
+  json["scene_position.y"] = this->pos.y();
+
+  // for info only
+  {
+    json["id"] = this->id;
+    json["caption"] = this->p_proxy ? this->p_proxy->get_caption() : std::string();
+  }
+
+  return json;
+}
+
+// --- LinkRecord
+
+NodeRecord *LinkRecord::get_shown_node_in() const
+{
+  return this->node_in->p_summary ? this->node_in->p_summary : this->node_in;
+}
+
+NodeRecord *LinkRecord::get_shown_node_out() const
+{
+  return this->node_out->p_summary ? this->node_out->p_summary : this->node_out;
+}
+
+int LinkRecord::get_shown_port_in() const
+{
+  return this->node_in->p_summary ? this->summary_port_in : this->port_in;
+}
+
+int LinkRecord::get_shown_port_out() const
+{
+  return this->node_out->p_summary ? this->summary_port_out : this->port_out;
+}
+
+bool LinkRecord::is_hidden() const
+{
+  return this->get_shown_port_out() < 0 || this->get_shown_port_in() < 0;
+}
+
+nlohmann::json LinkRecord::json_to(LinkType link_type) const
+{
+  nlohmann::json json;
+
+  json["node_out_id"] = this->node_out->id;
+  json["port_out_id"] = this->node_out->p_proxy
+                            ? this->node_out->p_proxy->get_port_id(this->port_out)
+                            : std::string();
+  json["node_in_id"] = this->node_in->id;
+  json["port_in_id"] = this->node_in->p_proxy
+                           ? this->node_in->p_proxy->get_port_id(this->port_in)
+                           : std::string();
+  json["link_type"] = link_type;
+
+  return json;
+}
+
+QRectF LinkRecord::rect() const
+{
+  return this->get_shown_node_out()->rect().united(this->get_shown_node_in()->rect());
+}
+
+// --- GroupNodeProxy
+
+GroupNodeProxy::GroupNodeProxy(const std::string &id, const std::string &caption)
+    : id(id), caption(caption)
+{
+}
+
+int GroupNodeProxy::add_port(NodeProxy *p_member, int member_port)
+{
+  this->ports.push_back({p_member, member_port, p_member->get_port_type(member_port)});
+  return (int)this->ports.size() - 1;
+}
+
+std::string GroupNodeProxy::get_port_caption(int port_index) const
+{
+  const Port &port = this->ports.at(port_index);
+
+  if (!port.p_member)
+    return std::string();
+
+  return port.p_member->get_caption() + ": " +
+         port.p_member->get_port_caption(port.member_port);
+}
+
+std::string GroupNodeProxy::get_port_id(int port_index) const
+{
+  const Port &port = this->ports.at(port_index);
+
+  if (!port.p_member)
+    return std::string();
+
+  return port.p_member->get_id() + "/" + port.p_member->get_port_id(port.member_port);
+}
+
+PortType GroupNodeProxy::get_port_type(int port_index) const
+{
+  return this->ports.at(port_index).type;
+}
+
+std::string GroupNodeProxy::get_data_type(int port_index) const
+{
+  const Port &port = this->ports.at(port_index);
+  return port.p_member ? port.p_member->get_data_type(port.member_port) : std::string();
+}
+
+std::string GroupNodeProxy::get_tool_tip_text() const
+{
+  return "Collapsed group, " + std::to_string(this->ports.size()) +
+         " boundary connection(s)";
+}
+
+// --- ChangeSet
+
+ChangeSet::Link ChangeSet::Link::from_record(const LinkRecord &record)
+{
+  Link link;
+
+  link.id_out = record.node_out->id;
+  link.id_in = record.node_in->id;
+  link.node_out = record.node_out->handle;
+  link.port_out = record.port_out;
+  link.node_in = record.node_in->handle;
+  link.port_in = record.port_in;
+
+  if (NodeProxy *p_proxy = record.node_out->p_proxy)
+    link.port_id_out = p_proxy->get_port_id(record.port_out);
+  if (NodeProxy *p_proxy = record.node_in->p_proxy)
+    link.port_id_in = p_proxy->get_port_id(record.port_in);
+
+  return link;
+}
+
+bool ChangeSet::Link::operator==(const Link &other) const
+{
+  return this->node_out == other.node_out && this->port_out == other.port_out &&
+         this->node_in == other.node_in && this->port_in == other.port_in;
+}
+
+void ChangeSet::add_link(const Link &link) { this->added_links.push_back(link); }
+
+void ChangeSet::add_node(const Node &node) { this->added_nodes.push_back(node); }
+
+bool ChangeSet::is_empty() const
+{
+  return this->added_nodes.empty() && this->removed_nodes.empty() &&
+         this->added_links.empty() && this->removed_links.empty();
+}
+
+void ChangeSet::remove_link(const Link &link)
+{
+  // added then removed, nothing to report
+  auto it = std::find(this->added_links.begin(), this->added_links.end(), link);
+
+  if (it != this->added_links.end())
+    this->added_links.erase(it);
+  else
+    this->removed_links.push_back(link);
+}
+
+void ChangeSet::remove_node(const Node &node)
+{
+  auto it = std::find_if(this->added_nodes.begin(),
+                         this->added_nodes.end(),
+                         [&node](const Node &other)
+                         { return other.handle == node.handle; });
+
+  if (it != this->added_nodes.end())
+    this->added_nodes.erase(it);
+  else
+    this->removed_nodes.push_back(node);
+}
+
+// --- helper
+
+QSizeF estimate_node_size(NodeProxy *p_proxy)
+{
+  // same layout as GraphicsNodeGeometry with a fixed line height, no
+  // font metrics involved since this runs for every node of the graph
+  const float line_height = GN_STYLE->node.vertical_stretching * 16.f;
+  const float margin = 2.f * GN_STYLE->node.port_radius;
+  const int   nports = p_proxy ? p_proxy->get_nports() : 0;
+
+  const float width = GN_STYLE->node.width + 2.f * margin;
+  const float height = line_height * (2.f + GN_STYLE->node.header_height_scale + nports) +
+                       2.f * margin;
+
+  return QSizeF(width, height);
+}
+
+} // namespace gngui
@@ -0,0 +1,54 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <QGraphicsView>
+
+#include "gnodegui/graph_scene.hpp"
+#include "gnodegui/graph_viewer.hpp"
+#include "gnodegui/style.hpp"
+
+namespace gngui
+{
+
+GraphScene::GraphScene(GraphViewer *p_main_viewer)
+    : QGraphicsScene(p_main_viewer), p_main_viewer(p_main_viewer),
+      compute_events(GN_STYLE->viewer.compute_event_capacity)
+{
+  this->thumbnail_cache = new ThumbnailCache(this);
+  this->command_queue = std::make_unique<CommandQueue<ViewerCommand>>(
+      GN_STYLE->viewer.command_queue_size);
+}
+
+GraphScene::~GraphScene()
+{
+  // links first: QGraphicsScene deletes its items in insertion order, and the links
+  // release the ports of their nodes when deleted
+  this->pending_link_paths.clear();
+  this->temp_link = nullptr;
+
+  for (auto &[p_record, _] : this->link_records)
+    p_record->p_link = nullptr;
+
+  for (QGraphicsItem *p_item : this->items())
+    if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(p_item))
+      delete p_link;
+
+  for (GraphicsLink *p_link : this->link_pool)
+    delete p_link;
+
+  for (GraphicsNode *p_node : this->node_pool)
+    delete p_node;
+}
+
+std::vector<GraphViewer *> GraphScene::get_viewers() const
+{
+  std::vector<GraphViewer *> viewers = {};
+
+  for (QGraphicsView *p_view : this->views())
+    if (GraphViewer *p_viewer = dynamic_cast<GraphViewer *>(p_view))
+      viewers.push_back(p_viewer);
+
+  return viewers;
+}
+
+} // namespace gngui
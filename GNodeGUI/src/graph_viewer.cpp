@@ -1,13 +1,21 @@
 /* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 
 #include <QCoreApplication>
+#include <QFileInfo>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QMenu>
+#include <QMetaMethod>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
 #include <QTimer>
 #include <QToolTip>
 #include <QWidgetAction>
@@ -16,7 +24,9 @@
 #include "gnodegui/graphics_comment.hpp"
 #include "gnodegui/graphics_group.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/png_stream_writer.hpp"
 #include "gnodegui/style.hpp"
+#include "gnodegui/task_scheduler.hpp"
 #include "gnodegui/utils.hpp"
 
 #include "gnodegui/icons/clear_all_icon.hpp"
@@ -38,23 +48,138 @@
 namespace gngui
 {
 
-GraphViewer::GraphViewer(std::string id, QWidget *parent) : QGraphicsView(parent), id(id)
+// toolbar background, only drawn in the view it belongs to
+class OverlayRectItem : public QGraphicsRectItem
+{
+public:
+  using QGraphicsRectItem::QGraphicsRectItem;
+
+  void paint(QPainter                       *painter,
+             const QStyleOptionGraphicsItem *option,
+             QWidget                        *widget) override
+  {
+    if (is_overlay_drawn_in(this, widget))
+      QGraphicsRectItem::paint(painter, option, widget);
+  }
+};
+
+GraphViewer::GraphViewer(std::string id, QWidget *parent) : QGraphicsView(parent)
 {
   Logger::log()->trace("GraphViewer::GraphViewer");
-  this->setRenderHint(QPainter::Antialiasing);
-  this->setRenderHint(QPainter::SmoothPixmapTransform);
-  this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-  this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-  this->setDragMode(QGraphicsView::NoDrag);
-  this->setFocusPolicy(Qt::StrongFocus);
 
-  this->setScene(new QGraphicsScene());
-  this->scene()->setSceneRect(-MAX_SIZE, -MAX_SIZE, (MAX_SIZE * 2), (MAX_SIZE * 2));
+  // the scene holds the graph state and is owned by this main viewer
+  this->graph_scene = new GraphScene(this);
+  this->graph_scene->id = id;
+  this->graph_scene->setSceneRect(-MAX_SIZE, -MAX_SIZE, (MAX_SIZE * 2), (MAX_SIZE * 2));
+  this->setScene(this->graph_scene);
+
+  // port data previews
+  this->connect(this->graph_scene->thumbnail_cache,
+                &ThumbnailCache::thumbnail_ready,
+                this,
+                [this](const std::string &node_id, int /* port_index */)
+                {
+                  // released nodes get it when materialized again
+                  NodeRecord *p_record = this->get_node_record(node_id);
+                  if (p_record && p_record->p_node)
+                    p_record->p_node->update_thumbnail();
+                });
+
+  this->setup_node_callbacks();
+  this->setup_view();
+
+  // emitted signals are counted for the statistics, the ones of the
+  // additional views end up here as well
+  const QMetaObject *p_meta = &GraphViewer::staticMetaObject;
+  const QMetaMethod  slot = p_meta->method(p_meta->indexOfSlot("on_signal_emitted()"));
+
+  for (int k = p_meta->methodOffset(); k < p_meta->methodCount(); k++)
+  {
+    const QMetaMethod method = p_meta->method(k);
 
-  this->setBackgroundBrush(QBrush(GN_STYLE->viewer.color_bg));
+    if (method.methodType() == QMetaMethod::Signal && method.name() != "stats_updated")
+      this->connect(this, method, this, slot);
+  }
+}
 
-  if (GN_STYLE->viewer.add_toolbar)
-    this->add_toolbar(GN_STYLE->viewer.toolbar_window_pos);
+GraphViewer::GraphViewer(GraphViewer *p_main_viewer, QWidget *parent)
+    : QGraphicsView(parent)
+{
+  Logger::log()->trace("GraphViewer::GraphViewer, additional view");
+
+  this->graph_scene = p_main_viewer->graph_scene;
+  this->setScene(this->graph_scene);
+
+  // the host only connects to the main viewer, signals of this view
+  // are forwarded to it
+  const QMetaObject *p_meta = &GraphViewer::staticMetaObject;
+
+  for (int k = p_meta->methodOffset(); k < p_meta->methodCount(); k++)
+  {
+    const QMetaMethod method = p_meta->method(k);
+
+    if (method.methodType() == QMetaMethod::Signal)
+      this->connect(this, method, p_main_viewer, method);
+  }
+
+  this->setup_view();
+}
+
+GraphViewer::~GraphViewer()
+{
+  // the scene is deleted with the main viewer, its additional views must not keep
+  // pointers to it nor to their overlay, which the scene would delete
+  if (this->graph_scene && this == this->graph_scene->get_main_viewer())
+    for (GraphViewer *p_viewer : this->graph_scene->get_viewers())
+      if (p_viewer != this)
+        p_viewer->detach_scene();
+
+  // the overlay of this view, the rest of the scene may outlive it
+  for (QGraphicsItem *item : this->static_items)
+  {
+    if (this->scene())
+      this->scene()->removeItem(item);
+    delete item;
+  }
+}
+
+GraphViewer::LinkPathBatch::LinkPathBatch(GraphViewer *p_viewer) : p_viewer(p_viewer)
+{
+  this->p_viewer->graph_scene->link_path_batch_depth++;
+}
+
+GraphViewer::LinkPathBatch::~LinkPathBatch()
+{
+  if (--this->p_viewer->graph_scene->link_path_batch_depth == 0)
+    this->p_viewer->flush_link_paths();
+}
+
+GraphicsLink *GraphViewer::acquire_link(QColor color, LinkType link_type)
+{
+  std::vector<GraphicsLink *> &pool = this->graph_scene->link_pool;
+
+  if (pool.empty())
+    return new GraphicsLink(color, link_type);
+
+  GraphicsLink *p_link = pool.back();
+  pool.pop_back();
+  p_link->reset(color, link_type);
+
+  return p_link;
+}
+
+GraphicsNode *GraphViewer::acquire_node(QPointer<NodeProxy> p_proxy)
+{
+  std::vector<GraphicsNode *> &pool = this->graph_scene->node_pool;
+
+  if (pool.empty())
+    return new GraphicsNode(p_proxy);
+
+  GraphicsNode *p_node = pool.back();
+  pool.pop_back();
+  p_node->reset(p_proxy);
+
+  return p_node;
 }
 
 void GraphViewer::add_item(QGraphicsItem *item, QPointF scene_pos)
@@ -62,15 +187,19 @@ void GraphViewer::add_item(QGraphicsItem *item, QPointF scene_pos)
   item->setPos(scene_pos);
   this->scene()->addItem(item);
 
-  // if this item is GraphicsNode, install the required event filter
-  if (GraphicsNode *node = dynamic_cast<GraphicsNode *>(item))
-    for (QGraphicsItem *other_item : this->scene()->items())
-      if (GraphicsNode *other_node = dynamic_cast<GraphicsNode *>(other_item))
-        if (node != other_node)
-        {
-          node->installSceneEventFilter(other_node);
-          other_node->installSceneEventFilter(node);
-        }
+  // handled by the main viewer, which lives as long as the scene
+  if (GraphicsGroup *p_group = dynamic_cast<GraphicsGroup *>(item))
+  {
+    GraphViewer *p_main = this->graph_scene->get_main_viewer();
+
+    p_group->collapse_toggled = [p_main](GraphicsGroup *group)
+    {
+      if (group->get_is_collapsed())
+        p_main->expand_group(group);
+      else
+        p_main->collapse_group(group);
+    };
+  }
 }
 
 void GraphViewer::add_link(const std::string &id_out,
@@ -78,27 +207,15 @@ void GraphViewer::add_link(const std::string &id_out,
                            const std::string &to_in,
                            const std::string &port_id_in)
 {
-  GraphicsNode *from_node = this->get_graphics_node_by_id(id_out);
-  GraphicsNode *to_node = this->get_graphics_node_by_id(to_in);
+  NodeRecord *p_from = this->get_node_record(id_out);
+  NodeRecord *p_to = this->get_node_record(to_in);
 
-  if (from_node && to_node)
+  if (p_from && p_to)
   {
-    int port_from_index = from_node->get_port_index(port_id_out);
-    int port_to_index = to_node->get_port_index(port_id_in);
-
-    QColor color = get_color_from_data_type(from_node->get_data_type(port_from_index));
-
-    GraphicsLink *p_new_link = new GraphicsLink(color, this->current_link_type);
-
-    p_new_link->set_pen_style(Qt::SolidLine);
-    p_new_link->set_endnodes(from_node, port_from_index, to_node, port_to_index);
-    p_new_link->update_path();
-
-    // mark those ports as connected
-    from_node->set_is_port_connected(port_from_index, p_new_link);
-    to_node->set_is_port_connected(port_to_index, p_new_link);
-
-    this->scene()->addItem(p_new_link);
+    this->add_link(p_from->handle,
+                   p_from->get_port_index(port_id_out),
+                   p_to->handle,
+                   p_to->get_port_index(port_id_in));
   }
   else
   {
@@ -109,44 +226,97 @@ void GraphViewer::add_link(const std::string &id_out,
   }
 }
 
-std::string GraphViewer::add_node(NodeProxy         *p_node_proxy,
-                                  QPointF            scene_pos,
-                                  const std::string &node_id)
+void GraphViewer::add_link(NodeHandle node_out,
+                           int        port_out,
+                           NodeHandle node_in,
+                           int        port_in)
 {
-  GraphicsNode *p_node = new GraphicsNode(p_node_proxy);
-  this->add_item(p_node, scene_pos);
+  NodeRecord *p_from = this->get_node_record(node_out);
+  NodeRecord *p_to = this->get_node_record(node_in);
+
+  auto is_port_valid = [](NodeRecord *p_record, int port_index)
+  {
+    return p_record && p_record->p_proxy && port_index >= 0 &&
+           port_index < p_record->p_proxy->get_nports();
+  };
 
-  p_node->right_clicked = [this](const std::string &port_index, QPointF scene_pos)
-  { this->on_node_right_clicked(port_index, scene_pos); };
+  if (!is_port_valid(p_from, port_out) || !is_port_valid(p_to, port_in))
+  {
+    Logger::log()->error("GraphViewer::add_link, invalid ports: {}:{} -> {}:{}",
+                         node_out,
+                         port_out,
+                         node_in,
+                         port_in);
+    return;
+  }
 
-  p_node->connection_started = [this](GraphicsNode *from, int port_index)
-  { this->on_connection_started(from, port_index); };
+  LinkRecord *p_record = this->add_link_record(p_from, port_out, p_to, port_in);
 
-  p_node->connection_finished =
-      [this](GraphicsNode *from, int port_from_index, GraphicsNode *to, int port_to_index)
-  { this->on_connection_finished(from, port_from_index, to, port_to_index); };
+  // with virtualization, the graphics link is only created in view
+  if (!GN_STYLE->viewer.virtualize_items || this->is_in_active_area(p_record->rect()))
+    this->materialize_link(p_record);
+}
 
-  p_node->connection_dropped =
-      [this](GraphicsNode *from, int port_index, QPointF scene_pos)
-  { this->on_connection_dropped(from, port_index, scene_pos); };
+LinkRecord *GraphViewer::add_link_record(NodeRecord *p_node_out,
+                                         int         port_out,
+                                         NodeRecord *p_node_in,
+                                         int         port_in)
+{
+  auto        record = std::make_unique<LinkRecord>();
+  LinkRecord *p_record = record.get();
 
-  p_node->selected = [this](const std::string &node_id)
-  {
-    Q_EMIT this->node_selected(node_id);
-    Q_EMIT this->selection_has_changed();
-  };
+  p_record->node_out = p_node_out;
+  p_record->port_out = port_out;
+  p_record->node_in = p_node_in;
+  p_record->port_in = port_in;
 
-  p_node->deselected = [this](const std::string &node_id)
-  {
-    Q_EMIT this->node_deselected(node_id);
-    Q_EMIT this->selection_has_changed();
-  };
+  this->graph_scene->link_records[p_record] = std::move(record);
+  p_node_out->links.push_back(p_record);
+  p_node_in->links.push_back(p_record);
+  this->graph_scene->link_grid.insert(p_record, p_record->rect());
+
+  this->graph_scene->pending_changes.add_link(ChangeSet::Link::from_record(*p_record));
+  this->schedule_graph_changed();
+
+  return p_record;
+}
 
+std::string GraphViewer::add_node(NodeProxy         *p_node_proxy,
+                                  QPointF            scene_pos,
+                                  const std::string &node_id)
+{
   // if nothing provided, generate a unique id based on the object address
-  std::string nid = node_id.empty() ? std::to_string(reinterpret_cast<uintptr_t>(p_node))
-                                    : node_id;
+  std::string nid = node_id.empty()
+                        ? std::to_string(reinterpret_cast<uintptr_t>(p_node_proxy))
+                        : node_id;
+
+  if (this->graph_scene->node_records.contains(nid))
+  {
+    Logger::log()->error("GraphViewer::add_node: node ID {} already in use", nid);
+    return nid;
+  }
 
   p_node_proxy->set_id(nid);
+
+  // a lightweight record for every node, the graphics item is only
+  // created when needed
+  NodeRecord &record = this->graph_scene->node_records[nid];
+  record.id = nid;
+  record.handle = this->graph_scene->next_handle++;
+  record.p_proxy = p_node_proxy;
+  record.pos = scene_pos;
+  record.size = estimate_node_size(p_node_proxy);
+  this->graph_scene->node_grid.insert(&record, record.rect());
+  this->graph_scene->handle_records[record.handle] = &record;
+
+  this->graph_scene->pending_changes.add_node({nid, record.handle});
+  this->schedule_graph_changed();
+
+  if (!GN_STYLE->viewer.virtualize_items || this->is_in_active_area(record.rect()))
+    this->materialize_node(&record);
+  else
+    this->schedule_items_update();
+
   return nid;
 }
 
@@ -156,6 +326,13 @@ void GraphViewer::add_static_item(QGraphicsItem *item, QPoint window_pos, float
   item->setFlag(QGraphicsItem::ItemIsMovable, false);
   item->setZValue(z_value);
 
+  // only drawn in this view when the scene is shared
+  set_overlay_view(item, this);
+
+  // icons are rendered once, shadow included, and then only blitted
+  if (AbstractIcon *p_icon = dynamic_cast<AbstractIcon *>(item))
+    p_icon->render_atlas(this->devicePixelRatioF());
+
   this->add_item(item);
   this->static_items.push_back(item);
   this->static_items_positions.push_back(window_pos);
@@ -243,10 +420,10 @@ void GraphViewer::add_toolbar(QPoint window_pos)
   }
 
   // add background
-  QGraphicsRectItem *background = new QGraphicsRectItem(0.f,
-                                                        0.f,
-                                                        width + 2.f * padding,
-                                                        y - dy + padding);
+  QGraphicsRectItem *background = new OverlayRectItem(0.f,
+                                                      0.f,
+                                                      width + 2.f * padding,
+                                                      y - dy + padding);
   background->setPen(QPen(QColor(0, 0, 0, 0)));
   background->setBrush(QBrush(QColor(21, 21, 21, 255)));
 
@@ -320,210 +497,864 @@ void GraphViewer::add_toolbar(QPoint window_pos)
   }
 }
 
-void GraphViewer::clear()
+void GraphViewer::apply_command(const ViewerCommand &command)
 {
-  std::vector<QGraphicsItem *> items_to_delete = {};
+  switch (command.type)
+  {
+  case ViewerCommandType::COMPUTE_FINISHED:
+  case ViewerCommandType::COMPUTE_STARTED:
+  case ViewerCommandType::COMPUTE_STATE:
+  {
+    ComputeState state = command.state;
 
-  for (QGraphicsItem *item : this->scene()->items())
-    if (!this->is_item_static(item))
+    if (command.type == ViewerCommandType::COMPUTE_FINISHED)
+      state = ComputeState::DONE;
+    else if (command.type == ViewerCommandType::COMPUTE_STARTED)
+      state = ComputeState::RUNNING;
+
+    // repainted once the whole batch is applied
+    if (NodeRecord *p_record = this->get_node_record(command.handle))
     {
-      item->setSelected(false);
-      this->scene()->removeItem(item);
-      items_to_delete.push_back(item);
+      this->apply_compute_state(p_record,
+                                state,
+                                false,
+                                command.time,
+                                command.thread_id);
+      this->schedule_compute_repaint();
     }
+    break;
+  }
 
-  this->viewport()->update();
+  case ViewerCommandType::UPDATE_FINISHED:
+    this->on_update_finished();
+    break;
 
-  for (auto item : items_to_delete)
-    clean_delete_graphics_item(item);
+  case ViewerCommandType::UPDATE_STARTED:
+    this->on_update_started();
 
-  Q_EMIT this->selection_has_changed();
+    if (command.time > 0)
+      this->graph_scene->pass_start_time = command.time;
+    break;
+  }
 }
 
-void GraphViewer::contextMenuEvent(QContextMenuEvent *event)
+void GraphViewer::apply_compute_state(NodeRecord  *p_record,
+                                      ComputeState state,
+                                      bool         update_item,
+                                      int64_t      time,
+                                      uint32_t     thread_id)
 {
-  // --- skip this if there is an item is under the cursor
+  const bool has_new_data = state == ComputeState::DONE ||
+                            state == ComputeState::CACHED;
 
-  QGraphicsItem *item = this->itemAt(event->pos());
+  if (time <= 0)
+    time = get_time_ns();
 
-  if (item)
-  {
-    QGraphicsView::contextMenuEvent(event);
-    return;
-  }
+  // runs only, queued or reset nodes are not shown by the timeline
+  if (state == ComputeState::RUNNING || state == ComputeState::FAILED ||
+      has_new_data)
+    this->graph_scene->compute_events.push({time, p_record->handle, thread_id, state});
 
-  // --- if not keep going
+  this->update_telemetry(p_record, state, time);
 
-  this->execute_new_node_context_menu();
+  if (GraphicsNode *p_node = p_record->p_node)
+  {
+    if (has_new_data)
+      p_node->on_compute_finished(update_item);
 
-  QGraphicsView::contextMenuEvent(event);
+    p_node->set_compute_state(state, update_item);
+  }
+  else
+  {
+    if (has_new_data)
+      p_record->data_version++;
+
+    p_record->compute_state = state;
+  }
 }
 
-void GraphViewer::delete_graphics_link(GraphicsLink *p_link, bool link_will_be_replaced)
+void GraphViewer::apply_link_metric(LinkRecord *p_record,
+                                    LinkMetric  metric,
+                                    double      value)
 {
-  if (!is_valid(p_link))
-  {
-    Logger::log()->error("GraphViewer::delete_graphics_link: invalid link provided.");
+  p_record->telemetry.set(metric, value);
+
+  DataflowOverlay &overlay = this->graph_scene->dataflow_overlay;
+
+  if (!overlay.is_visible)
     return;
-  }
 
-  GraphicsNode *node_out = p_link->get_node_out();
-  GraphicsNode *node_in = p_link->get_node_in();
-  int           port_out = p_link->get_port_out_index();
-  int           port_in = p_link->get_port_in_index();
+  // repainted at the next frame, whatever the number of updates until then
+  if (overlay.width_metric == metric)
+    overlay.max_width_value = std::max(overlay.max_width_value,
+                                       p_record->telemetry.get(metric));
 
-  const std::string node_out_id = node_out ? node_out->get_id() : "";
-  const std::string node_in_id = node_in ? node_in->get_id() : "";
-  const std::string node_out_port_id = node_out ? node_out->get_port_id(port_out) : "";
-  const std::string node_in_port_id = node_in ? node_in->get_port_id(port_in) : "";
+  if (overlay.color_metric == metric)
+    overlay.max_color_value = std::max(overlay.max_color_value,
+                                       p_record->telemetry.get(metric));
 
-  Logger::log()->trace("Deleting link: {}:{} -> {}:{}, will_be_replaced={}",
-                       node_out_id,
-                       node_out_port_id,
-                       node_in_id,
-                       node_in_port_id,
-                       link_will_be_replaced ? "T" : "F");
+  if (overlay.width_metric == metric || overlay.color_metric == metric)
+    this->schedule_compute_repaint();
+}
+
+void GraphViewer::apply_zoom(float factor, QPoint anchor_pos)
+{
+  this->start_navigation();
 
-  // Disconnect nodes safely
-  if (node_out)
-    node_out->set_is_port_connected(port_out, nullptr);
-  if (node_in)
-    node_in->set_is_port_connected(port_in, nullptr);
+  QPointF anchor_scene_pos = this->mapToScene(anchor_pos);
 
-  // Delete the link
-  clean_delete_graphics_item(p_link);
+  this->scale(factor, factor);
 
-  // Emit signal
-  if (node_out && node_in)
-    Q_EMIT connection_deleted(node_out_id,
-                              node_out_port_id,
-                              node_in_id,
-                              node_in_port_id,
-                              link_will_be_replaced);
+  // adjust the view to maintain the zoom centered on the anchor position
+  QPointF new_anchor_scene_pos = this->mapToScene(anchor_pos);
+  QPointF delta = new_anchor_scene_pos - anchor_scene_pos;
+  this->translate(delta.x(), delta.y());
+
+  this->schedule_items_update();
 }
 
-void GraphViewer::delete_graphics_node(GraphicsNode *p_node)
+void GraphViewer::clear()
 {
-  if (!is_valid(p_node))
-  {
-    Logger::log()->error("GraphViewer::delete_graphics_node: invalid node provided.");
-    return;
-  }
+  this->graph_scene->live_widget_nodes.clear();
+  this->graph_scene->thumbnail_cache->clear();
+  this->graph_scene->materialized_nodes.clear();
+  this->graph_scene->materialized_links.clear();
 
-  Logger::log()->trace("GraphicsNode removing, id: {}", p_node->get_id());
+  std::vector<QGraphicsItem *> items_to_delete = {};
+  std::vector<GraphicsNode *>  nodes_to_recycle = {};
+  std::vector<GraphicsLink *>  links_to_recycle = {};
 
-  // Remove any connected links
-  QList<QGraphicsItem *> items_copy = scene()->items();
-  for (QGraphicsItem *item : items_copy)
-  {
-    if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
+    if (!this->is_item_static(item))
     {
-      if (p_link->get_node_out() == p_node || p_link->get_node_in() == p_node)
-        this->delete_graphics_link(p_link, false);
+      item->setSelected(false);
+      this->scene()->removeItem(item);
+
+      if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
+        nodes_to_recycle.push_back(p_node);
+      else if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
+        links_to_recycle.push_back(p_link);
+      else
+        items_to_delete.push_back(item);
     }
-  }
 
-  // Delete node
-  const std::string deleted_id = p_node->get_id();
-  clean_delete_graphics_item(p_node);
+  this->viewport()->update();
 
-  Q_EMIT node_deleted(deleted_id);
+  for (auto item : items_to_delete)
+    clean_delete_graphics_item(item);
+
+  // kept for the next graph, usually loaded right after
+  for (auto p_link : links_to_recycle)
+    this->recycle_link(p_link);
+  for (auto p_node : nodes_to_recycle)
+    this->recycle_node(p_node);
+
+  this->graph_scene->temp_link = nullptr;
+  this->graph_scene->source_node = nullptr;
+
+  // records last, items do not refer to them
+  this->graph_scene->link_records.clear();
+  this->graph_scene->node_records.clear();
+  this->graph_scene->handle_records.clear();
+  this->graph_scene->pending_changes = ChangeSet(); // refers to the cleared graph
+  this->graph_scene->compute_events.clear();
+  this->graph_scene->collapsed_groups.clear();
+  this->graph_scene->node_grid.clear();
+  this->graph_scene->link_grid.clear();
+  for (GraphViewer *p_viewer : this->graph_scene->get_viewers())
+    p_viewer->active_rect = QRectF();
+
+  Q_EMIT this->selection_has_changed();
 }
 
-void GraphViewer::delete_selected_items()
+void GraphViewer::clear_compute_events() { this->graph_scene->compute_events.clear(); }
+
+void GraphViewer::collapse_group(GraphicsGroup *p_group)
 {
-  QGraphicsScene *scene = this->scene();
-  if (!scene)
+  if (!p_group || this->graph_scene->collapsed_groups.contains(p_group))
     return;
 
-  this->set_enabled(false);
+  Logger::log()->trace("GraphViewer::collapse_group: {}", p_group->get_caption());
 
-  auto selected_items = scene->selectedItems();
+  // members are the nodes entirely inside the group (items are synced
+  // first, they may have been moved since)
+  const QRectF bbox = p_group->sceneBoundingRect();
 
-  std::vector<GraphicsLink *>  links_to_delete;
-  std::vector<GraphicsNode *>  nodes_to_delete;
-  std::vector<QGraphicsItem *> other_items;
+  for (NodeRecord *p_record : this->graph_scene->materialized_nodes)
+    this->sync_node_record(p_record);
 
-  // Separate items in a single pass
-  for (QGraphicsItem *item : selected_items)
+  std::vector<NodeRecord *> candidates;
+  this->graph_scene->node_grid.query(bbox, candidates);
+
+  auto p_collapsed = std::make_unique<CollapsedGroup>();
+
+  for (NodeRecord *p_record : candidates)
+    if (!p_record->is_summary && !p_record->p_summary && bbox.contains(p_record->rect()))
+      p_collapsed->members.push_back(p_record);
+
+  if (p_collapsed->members.empty())
+    return;
+
+  // member items are released, or only hidden for the ones holding a
+  // widget that cannot be rebuilt
+  for (NodeRecord *p_record : p_collapsed->members)
   {
-    if (!scene->items().contains(item))
-      continue;
+    if (GraphicsNode *p_node = p_record->p_node)
+    {
+      p_node->setSelected(false);
 
-    if (auto p_link = dynamic_cast<GraphicsLink *>(item))
-      links_to_delete.push_back(p_link);
-    else if (auto p_node = dynamic_cast<GraphicsNode *>(item))
-      nodes_to_delete.push_back(p_node);
-    else
-      other_items.push_back(item);
+      if (p_node->has_widget() && !p_record->widget_factory)
+      {
+        for (LinkRecord *p_link_record : p_record->links)
+          if (p_link_record->p_link)
+            this->release_link(p_link_record);
+
+        p_node->setVisible(false);
+      }
+      else
+        this->release_node(p_record);
+    }
+
+    p_record->is_selected = false;
   }
 
-  // Delete links first
-  for (auto p_link : links_to_delete)
-    this->delete_graphics_link(p_link);
+  // summary node, with one port per member port connected to the
+  // outside of the group
+  const std::string summary_id = "group_" + std::to_string(
+                                                reinterpret_cast<uintptr_t>(p_group));
+  NodeRecord       *p_summary = &p_collapsed->summary;
 
-  // Then nodes
-  for (auto p_node : nodes_to_delete)
-    this->delete_graphics_node(p_node);
+  p_collapsed->p_proxy = std::make_unique<GroupNodeProxy>(summary_id,
+                                                          p_group->get_caption());
 
-  // Finally, any remaining items
-  for (auto item : other_items)
-    clean_delete_graphics_item(item);
+  for (NodeRecord *p_record : p_collapsed->members)
+    p_record->p_summary = p_summary;
 
-  this->set_enabled(true);
+  std::map<std::pair<NodeRecord *, int>, int> summary_ports;
 
-  Q_EMIT this->selection_has_changed();
-}
+  for (NodeRecord *p_record : p_collapsed->members)
+    for (LinkRecord *p_link_record : p_record->links)
+    {
+      const bool is_out_inside = p_link_record->node_out->p_summary == p_summary;
+      const bool is_in_inside = p_link_record->node_in->p_summary == p_summary;
 
-void GraphViewer::deselect_all()
-{
-  auto items = scene()->items();
+      // internal links are simply not shown, boundary links are only
+      // visited once since a single end is inside
+      if (is_out_inside && is_in_inside)
+        continue;
 
-  for (QGraphicsItem *item : items)
-    if (!is_item_static(item))
-      item->setSelected(false);
+      const auto key = is_out_inside
+                           ? std::pair(p_link_record->node_out, p_link_record->port_out)
+                           : std::pair(p_link_record->node_in, p_link_record->port_in);
 
-  Q_EMIT this->selection_has_changed();
+      if (!key.first->p_proxy)
+        continue;
+
+      if (!summary_ports.contains(key))
+        summary_ports[key] = p_collapsed->p_proxy->add_port(key.first->p_proxy,
+                                                            key.second);
+
+      if (is_out_inside)
+        p_link_record->summary_port_out = summary_ports.at(key);
+      else
+        p_link_record->summary_port_in = summary_ports.at(key);
+
+      p_summary->links.push_back(p_link_record);
+    }
+
+  p_summary->id = summary_id;
+  p_summary->p_proxy = p_collapsed->p_proxy.get();
+  p_summary->is_summary = true;
+  p_summary->size = estimate_node_size(p_summary->p_proxy);
+  p_summary->pos = bbox.center() - QPointF(0.5f * p_summary->size.width(),
+                                           0.5f * p_summary->size.height());
+  p_collapsed->origin = p_summary->pos;
+
+  this->graph_scene->node_grid.insert(p_summary, p_summary->rect());
+
+  for (LinkRecord *p_link_record : p_summary->links)
+    this->graph_scene->link_grid.move(p_link_record, p_link_record->rect());
+
+  this->graph_scene->collapsed_groups[p_group] = std::move(p_collapsed);
+  p_group->set_is_collapsed(true);
+
+  // summary node and rerouted links get their items
+  if (!GN_STYLE->viewer.virtualize_items || this->is_in_active_area(p_summary->rect()))
+    this->materialize_node(p_summary);
+
+  this->update_items(true);
 }
 
-void GraphViewer::drawForeground(QPainter *painter, const QRectF &rect)
+CriticalPath GraphViewer::compute_critical_path()
 {
-  QGraphicsView::drawForeground(painter, rect);
+  GraphScene  *p_scene = this->graph_scene;
+  CriticalPath critical_path;
 
-  for (size_t k = 0; k < this->static_items.size(); k++)
+  // nodes of the analysis, group summary nodes are not part of the graph
+  std::vector<NodeRecord *>                records;
+  std::unordered_map<NodeRecord *, size_t> indices;
+
+  for (auto &[_, record] : p_scene->node_records)
   {
-    // Keep the static item at a fixed position
-    QPointF scene_pos = this->mapToScene(this->viewport()->rect().topLeft() +
-                                         this->static_items_positions[k]);
-    this->static_items[k]->setPos(scene_pos);
+    record.telemetry.slack = -1.0;
+    record.telemetry.is_critical = false;
+
+    if (record.is_summary)
+      continue;
+
+    indices[&record] = records.size();
+    records.push_back(&record);
   }
-}
 
-bool GraphViewer::execute_new_node_context_menu()
-{
-  QMenu *menu = new QMenu(this);
+  const size_t        n = records.size();
+  std::vector<double> durations(n, 0.0);
 
-  // backup mouse position
-  QPointF mouse_scene_pos = this->get_mouse_scene_pos();
+  // the data of the nodes not computed during the last pass was already there
+  for (size_t k = 0; k < n; k++)
+  {
+    const NodeTelemetry &telemetry = records[k]->telemetry;
 
-  // add filterbox to the context menu
-  QLineEdit *text_box = new QLineEdit(menu);
-  text_box->setPlaceholderText(QStringLiteral("Filter or [SPACE]"));
-  text_box->setClearButtonEnabled(true);
-  // hesiod::resize_font(text_box, -2);
+    if (telemetry.end_time >= 0 && telemetry.end_time >= p_scene->pass_start_time)
+      durations[k] = telemetry.duration;
+  }
 
-  QWidgetAction *text_box_action = new QWidgetAction(menu);
-  text_box_action->setDefaultWidget(text_box);
+  // topology
+  std::vector<std::vector<std::pair<size_t, LinkRecord *>>> successors(n);
+  std::vector<int>                                          in_degrees(n, 0);
 
-  menu->addAction(text_box_action);
+  for (auto &[p_record, _] : p_scene->link_records)
+  {
+    p_record->is_critical = false;
 
-  // sort node types by category (not by types for the treeview)
-  std::vector<std::pair<std::string, std::string>> pairs;
-  for (auto itr = this->node_inventory.begin(); itr != this->node_inventory.end(); ++itr)
-    pairs.push_back(*itr);
+    auto it_out = indices.find(p_record->node_out);
+    auto it_in = indices.find(p_record->node_in);
 
-  sort(pairs.begin(),
-       pairs.end(),
+    if (it_out == indices.end() || it_in == indices.end())
+      continue;
+
+    successors[it_out->second].push_back({it_in->second, p_record});
+    in_degrees[it_in->second]++;
+  }
+
+  // topological order (Kahn), the nodes of a cycle never get in
+  std::vector<size_t> order;
+  std::vector<bool>   is_ordered(n, false);
+
+  order.reserve(n);
+
+  for (size_t k = 0; k < n; k++)
+    if (in_degrees[k] == 0)
+      order.push_back(k);
+
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    is_ordered[order[i]] = true;
+
+    for (auto &[s, _] : successors[order[i]])
+      if (--in_degrees[s] == 0)
+        order.push_back(s);
+  }
+
+  if (order.size() < n)
+    Logger::log()->error("GraphViewer::compute_critical_path: cycle detected, {} "
+                         "node(s) left out",
+                         n - order.size());
+
+  // earliest start and finish, forward pass
+  std::vector<double> starts(n, 0.0);
+  std::vector<double> finishes(n, 0.0);
+  std::vector<size_t> predecessors(n, SIZE_MAX); // the one finishing last
+  size_t              k_end = SIZE_MAX;
+
+  for (size_t k : order)
+  {
+    finishes[k] = starts[k] + durations[k];
+
+    if (k_end == SIZE_MAX || finishes[k] > finishes[k_end])
+      k_end = k;
+
+    for (auto &[s, _] : successors[k])
+      if (predecessors[s] == SIZE_MAX || finishes[k] > starts[s])
+      {
+        starts[s] = finishes[k];
+        predecessors[s] = k;
+      }
+  }
+
+  if (k_end == SIZE_MAX)
+    return critical_path;
+
+  critical_path.total_duration = finishes[k_end];
+
+  // latest finish not delaying the pass, backward pass
+  std::vector<double> latest_finishes(n, critical_path.total_duration);
+
+  for (auto it = order.rbegin(); it != order.rend(); ++it)
+    for (auto &[s, _] : successors[*it])
+      if (is_ordered[s])
+        latest_finishes[*it] = std::min(latest_finishes[*it],
+                                        latest_finishes[s] - durations[s]);
+
+  // rounding errors on sums of durations, in milliseconds
+  const double epsilon = 1e-6;
+  const bool   has_duration = critical_path.total_duration > epsilon;
+
+  for (size_t k : order)
+  {
+    NodeTelemetry &telemetry = records[k]->telemetry;
+
+    telemetry.slack = std::max(0.0, latest_finishes[k] - finishes[k]);
+    telemetry.is_critical = has_duration && telemetry.slack <= epsilon;
+
+    critical_path.slacks[records[k]->handle] = telemetry.slack;
+  }
+
+  // critical links, the upstream node finishing right when the downstream one starts
+  for (size_t k : order)
+    for (auto &[s, p_record] : successors[k])
+      p_record->is_critical = records[k]->telemetry.is_critical &&
+                              records[s]->telemetry.is_critical &&
+                              finishes[k] + epsilon >= starts[s];
+
+  // a single chain, from its end
+  if (has_duration)
+  {
+    for (size_t k = k_end; k != SIZE_MAX; k = predecessors[k])
+      critical_path.nodes.push_back(records[k]->handle);
+
+    std::reverse(critical_path.nodes.begin(), critical_path.nodes.end());
+  }
+
+  Logger::log()->trace("GraphViewer::compute_critical_path: {} node(s), {:.3f} ms",
+                       critical_path.nodes.size(),
+                       critical_path.total_duration);
+
+  if (p_scene->telemetry_overlay.is_critical_path_visible)
+  {
+    this->update_critical_links();
+    this->schedule_compute_repaint();
+  }
+
+  return critical_path;
+}
+
+void GraphViewer::contextMenuEvent(QContextMenuEvent *event)
+{
+  // --- skip this if there is an item is under the cursor
+
+  QGraphicsItem *item = this->itemAt(event->pos());
+
+  if (item)
+  {
+    QGraphicsView::contextMenuEvent(event);
+    return;
+  }
+
+  // --- if not keep going, no new node while busy
+
+  if (!this->is_busy())
+    this->execute_new_node_context_menu();
+
+  QGraphicsView::contextMenuEvent(event);
+}
+
+void GraphViewer::delete_graphics_link(GraphicsLink *p_link, bool link_will_be_replaced)
+{
+  if (!is_valid(p_link))
+  {
+    Logger::log()->error("GraphViewer::delete_graphics_link: invalid link provided.");
+    return;
+  }
+
+  if (LinkRecord *p_record = this->get_link_record(p_link))
+    this->delete_link_record(p_record, link_will_be_replaced);
+  else
+    this->recycle_link(p_link); // not part of the graph (e.g. temporary link)
+}
+
+void GraphViewer::delete_graphics_node(GraphicsNode *p_node)
+{
+  if (!is_valid(p_node))
+  {
+    Logger::log()->error("GraphViewer::delete_graphics_node: invalid node provided.");
+    return;
+  }
+
+  if (NodeRecord *p_record = this->get_node_record(p_node->get_id()))
+    this->delete_node_record(p_record);
+}
+
+void GraphViewer::delete_link_record(LinkRecord *p_record, bool link_will_be_replaced)
+{
+  NodeProxy *p_proxy_out = p_record->node_out->p_proxy;
+  NodeProxy *p_proxy_in = p_record->node_in->p_proxy;
+
+  const std::string node_out_id = p_record->node_out->id;
+  const std::string node_in_id = p_record->node_in->id;
+  const NodeHandle  node_out_handle = p_record->node_out->handle;
+  const NodeHandle  node_in_handle = p_record->node_in->handle;
+  const int         port_out = p_record->port_out;
+  const int         port_in = p_record->port_in;
+  const std::string node_out_port_id = p_proxy_out
+                                           ? p_proxy_out->get_port_id(p_record->port_out)
+                                           : "";
+  const std::string node_in_port_id = p_proxy_in
+                                          ? p_proxy_in->get_port_id(p_record->port_in)
+                                          : "";
+
+  Logger::log()->trace("Deleting link: {}:{} -> {}:{}, will_be_replaced={}",
+                       node_out_id,
+                       node_out_port_id,
+                       node_in_id,
+                       node_in_port_id,
+                       link_will_be_replaced ? "T" : "F");
+
+  this->graph_scene->pending_changes.remove_link(ChangeSet::Link::from_record(*p_record));
+  this->schedule_graph_changed();
+
+  // delete the link, if any, then its record
+  if (p_record->p_link)
+    this->release_link(p_record);
+
+  std::erase(p_record->node_out->links, p_record);
+  std::erase(p_record->node_in->links, p_record);
+
+  if (p_record->node_out->p_summary)
+    std::erase(p_record->node_out->p_summary->links, p_record);
+  if (p_record->node_in->p_summary)
+    std::erase(p_record->node_in->p_summary->links, p_record);
+
+  this->graph_scene->link_grid.remove(p_record);
+  this->graph_scene->link_records.erase(p_record);
+
+  // Emit signal
+  Q_EMIT connection_deleted(node_out_id,
+                            node_out_port_id,
+                            node_in_id,
+                            node_in_port_id,
+                            link_will_be_replaced);
+
+  Q_EMIT connection_deleted_by_handle(node_out_handle,
+                                      port_out,
+                                      node_in_handle,
+                                      port_in,
+                                      link_will_be_replaced);
+}
+
+void GraphViewer::delete_node_record(NodeRecord *p_record)
+{
+  Logger::log()->trace("GraphicsNode removing, id: {}", p_record->id);
+
+  // Remove any connected links, released ones included
+  const std::vector<LinkRecord *> links = p_record->links;
+  for (LinkRecord *p_link_record : links)
+    this->delete_link_record(p_link_record, false);
+
+  // Delete node
+  const std::string deleted_id = p_record->id;
+
+  if (GraphicsNode *p_node = p_record->p_node)
+  {
+    this->graph_scene->materialized_nodes.erase(p_record);
+    this->graph_scene->live_widget_nodes.remove(p_node);
+    p_node->setSelected(false); // reported, unlike the silent pool reset
+    this->recycle_node(p_node);
+  }
+
+  // hidden in a collapsed group
+  if (p_record->p_summary)
+    for (auto &[_, p_collapsed] : this->graph_scene->collapsed_groups)
+      std::erase(p_collapsed->members, p_record);
+
+  this->graph_scene->thumbnail_cache->remove_node(deleted_id);
+  this->graph_scene->node_grid.remove(p_record);
+  this->graph_scene->handle_records.erase(p_record->handle);
+
+  this->graph_scene->pending_changes.remove_node({deleted_id, p_record->handle});
+  this->schedule_graph_changed();
+
+  this->graph_scene->node_records.erase(deleted_id);
+
+  Q_EMIT node_deleted(deleted_id);
+}
+
+void GraphViewer::delete_selected_items()
+{
+  QGraphicsScene *scene = this->scene();
+  if (!scene)
+    return;
+
+  this->set_enabled(false);
+
+  auto selected_items = scene->selectedItems();
+
+  std::vector<GraphicsLink *>  links_to_delete;
+  std::vector<GraphicsNode *>  nodes_to_delete;
+  std::vector<QGraphicsItem *> other_items;
+
+  // Separate items in a single pass
+  for (QGraphicsItem *item : selected_items)
+  {
+    if (item->scene() != scene)
+      continue;
+
+    if (auto p_link = dynamic_cast<GraphicsLink *>(item))
+      links_to_delete.push_back(p_link);
+    else if (auto p_node = dynamic_cast<GraphicsNode *>(item))
+      nodes_to_delete.push_back(p_node);
+    else
+      other_items.push_back(item);
+  }
+
+  // Delete links first
+  for (auto p_link : links_to_delete)
+    this->delete_graphics_link(p_link);
+
+  // Then nodes, including the selected ones without graphics item
+  for (auto p_node : nodes_to_delete)
+    this->delete_graphics_node(p_node);
+
+  std::vector<NodeRecord *> records_to_delete;
+
+  for (auto &[_, record] : this->graph_scene->node_records)
+    if (!record.p_node && record.is_selected)
+      records_to_delete.push_back(&record);
+
+  for (auto p_record : records_to_delete)
+    this->delete_node_record(p_record);
+
+  // Finally, any remaining items, collapsed groups give their nodes
+  // back first
+  for (auto item : other_items)
+  {
+    if (GraphicsGroup *p_group = dynamic_cast<GraphicsGroup *>(item))
+      this->expand_group(p_group);
+
+    clean_delete_graphics_item(item);
+  }
+
+  this->set_enabled(true);
+
+  Q_EMIT this->selection_has_changed();
+}
+
+void GraphViewer::deselect_all()
+{
+  auto items = get_scene_items(this->scene());
+
+  for (QGraphicsItem *item : items)
+    if (!is_item_static(item))
+      item->setSelected(false);
+
+  for (auto &[_, record] : this->graph_scene->node_records)
+    record.is_selected = false;
+
+  Q_EMIT this->selection_has_changed();
+}
+
+void GraphViewer::detach_scene()
+{
+  Logger::log()->trace("GraphViewer::detach_scene");
+
+  this->navigation_timer->stop();
+  this->frame_timer->stop();
+  this->stats_timer->stop();
+
+  for (QGraphicsItem *item : this->static_items)
+  {
+    this->scene()->removeItem(item);
+    delete item;
+  }
+
+  this->static_items.clear();
+  this->static_items_positions.clear();
+
+  // left empty and without input, only to be deleted by its owner
+  this->setScene(nullptr);
+  this->graph_scene = nullptr;
+  this->setEnabled(false);
+}
+
+void GraphViewer::drawBackground(QPainter *painter, const QRectF &rect)
+{
+  QGraphicsView::drawBackground(painter, rect);
+
+  if (this->is_lod_active)
+    this->draw_records(painter, rect);
+}
+
+void GraphViewer::drawForeground(QPainter *painter, const QRectF &rect)
+{
+  QGraphicsView::drawForeground(painter, rect);
+
+  for (size_t k = 0; k < this->static_items.size(); k++)
+  {
+    // Keep the static item at a fixed position
+    QPointF scene_pos = this->mapToScene(this->viewport()->rect().topLeft() +
+                                         this->static_items_positions[k]);
+    this->static_items[k]->setPos(scene_pos);
+  }
+
+  if (this->graph_scene->dataflow_overlay.is_visible)
+    this->draw_dataflow_legend(painter);
+}
+
+void GraphViewer::draw_dataflow_legend(QPainter *painter)
+{
+  const DataflowOverlay &overlay = this->graph_scene->dataflow_overlay;
+
+  auto format_max = [](LinkMetric metric, double value)
+  {
+    LinkTelemetry telemetry;
+    telemetry.set(metric, value);
+    return telemetry.format(metric);
+  };
+
+  const QString width_caption = QString::fromStdString(
+      "Width: " + get_link_metric_caption(overlay.width_metric) + ", max " +
+      format_max(overlay.width_metric, overlay.max_width_value));
+  const QString color_caption = QString::fromStdString(
+      "Color: " + get_link_metric_caption(overlay.color_metric) + ", max " +
+      format_max(overlay.color_metric, overlay.max_color_value));
+
+  painter->save();
+  painter->resetTransform();
+
+  // bottom left corner: width caption and strokes, color caption and gradient
+  const QFontMetrics font_metrics = painter->fontMetrics();
+  const float        line_height = font_metrics.height();
+  const float        margin = 8.f;
+  const float        bar_width = std::max(
+      {160.f,
+       (float)font_metrics.horizontalAdvance(width_caption),
+       (float)font_metrics.horizontalAdvance(color_caption)});
+
+  const QRectF box(margin,
+                   this->viewport()->height() - 4.f * line_height - 3.f * margin,
+                   bar_width + 2.f * margin,
+                   4.f * line_height + 2.f * margin);
+
+  QColor color_bg = GN_STYLE->viewer.color_bg;
+  color_bg.setAlphaF(0.8f);
+
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(color_bg);
+  painter->drawRoundedRect(box, 4.f, 4.f);
+
+  const float x = box.left() + margin;
+  float       y = box.top() + margin;
+
+  painter->setPen(GN_STYLE->link.color_default);
+  painter->drawText(QRectF(x, y, bar_width, line_height),
+                    Qt::AlignVCenter | Qt::AlignLeft,
+                    width_caption);
+  y += line_height;
+
+  const float w0 = 0.5f * GN_STYLE->link.pen_width;
+  const float w1 = 0.5f * GN_STYLE->link.pen_width_dataflow_max;
+  const float yc = y + 0.5f * line_height;
+
+  QPolygonF strokes;
+  strokes << QPointF(x, yc - w0) << QPointF(x + bar_width, yc - w1)
+          << QPointF(x + bar_width, yc + w1) << QPointF(x, yc + w0);
+
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(GN_STYLE->link.color_default);
+  painter->drawPolygon(strokes);
+  y += line_height;
+
+  painter->setPen(GN_STYLE->link.color_default);
+  painter->drawText(QRectF(x, y, bar_width, line_height),
+                    Qt::AlignVCenter | Qt::AlignLeft,
+                    color_caption);
+  y += line_height;
+
+  QLinearGradient gradient(x, 0.f, x + bar_width, 0.f);
+  gradient.setColorAt(0.f, GN_STYLE->link.color_dataflow_low);
+  gradient.setColorAt(1.f, GN_STYLE->link.color_dataflow_high);
+
+  painter->fillRect(QRectF(x, y + 0.25f * line_height, bar_width, 0.5f * line_height),
+                    gradient);
+
+  painter->restore();
+}
+
+void GraphViewer::draw_records(QPainter *painter, const QRectF &rect)
+{
+  // zoomed out too far for the items to be readable, records are drawn
+  // as plain shapes instead: links as lines, nodes as rectangles with
+  // their header color
+  std::vector<LinkRecord *> links;
+  std::vector<NodeRecord *> nodes;
+  this->graph_scene->link_grid.query(rect, links);
+  this->graph_scene->node_grid.query(rect, nodes);
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing, false);
+
+  painter->setPen(QPen(GN_STYLE->link.color_default, 0.f));
+
+  for (LinkRecord *p_record : links)
+  {
+    if (p_record->is_hidden())
+      continue;
+
+    const QRectF rect_out = p_record->get_shown_node_out()->rect();
+    const QRectF rect_in = p_record->get_shown_node_in()->rect();
+    painter->drawLine(QPointF(rect_out.right(), rect_out.center().y()),
+                      QPointF(rect_in.left(), rect_in.center().y()));
+  }
+
+  painter->setPen(Qt::NoPen);
+
+  for (NodeRecord *p_record : nodes)
+  {
+    if (p_record->p_summary)
+      continue;
+
+    QColor color = GN_STYLE->node.color_bg_light;
+
+    if (p_record->p_proxy)
+    {
+      const std::string category = p_record->p_proxy->get_category();
+      const std::string main_category = category.substr(0, category.find("/"));
+
+      if (GN_STYLE->node.color_category.contains(main_category))
+        color = GN_STYLE->node.color_category.at(main_category);
+    }
+
+    painter->fillRect(p_record->rect(),
+                      p_record->is_selected ? GN_STYLE->node.color_selected : color);
+  }
+
+  painter->restore();
+}
+
+bool GraphViewer::execute_new_node_context_menu()
+{
+  QMenu *menu = new QMenu(this);
+
+  // backup mouse position
+  QPointF mouse_scene_pos = this->get_mouse_scene_pos();
+
+  // add filterbox to the context menu
+  QLineEdit *text_box = new QLineEdit(menu);
+  text_box->setPlaceholderText(QStringLiteral("Filter or [SPACE]"));
+  text_box->setClearButtonEnabled(true);
+  // hesiod::resize_font(text_box, -2);
+
+  QWidgetAction *text_box_action = new QWidgetAction(menu);
+  text_box_action->setDefaultWidget(text_box);
+
+  menu->addAction(text_box_action);
+
+  // sort node types by category (not by types for the treeview)
+  std::vector<std::pair<std::string, std::string>> pairs;
+  for (auto &item : this->graph_scene->node_inventory)
+    pairs.push_back(item);
+
+  sort(pairs.begin(),
+       pairs.end(),
        [=](std::pair<std::string, std::string> &a, std::pair<std::string, std::string> &b)
        {
          if (a.second == b.second)
@@ -580,7 +1411,7 @@ bool GraphViewer::execute_new_node_context_menu()
         // add everything
         if (!filtering_active)
         {
-          for (const auto &[key, _] : this->node_inventory)
+          for (const auto &[key, _] : this->graph_scene->node_inventory)
             menu->addAction(QString::fromStdString(key));
 
           filtering_active = true;
@@ -589,7 +1420,7 @@ bool GraphViewer::execute_new_node_context_menu()
         // determine who's visible
         std::map<std::string, bool> is_visible = {};
 
-        for (const auto &[key, _] : this->node_inventory)
+        for (const auto &[key, _] : this->graph_scene->node_inventory)
         {
           QString    key_qstr = QString::fromStdString(key);
           const bool match = key_qstr.contains(text, Qt::CaseInsensitive);
@@ -625,51 +1456,304 @@ bool GraphViewer::execute_new_node_context_menu()
   }
 }
 
-void GraphViewer::export_to_graphviz(const std::string &fname)
+void GraphViewer::expand_group(GraphicsGroup *p_group)
 {
-  // after export: to convert, command line: dot export.dot -Tsvg > output.svg
-
-  Logger::log()->trace("exporting to graphviz format...");
+  auto it = this->graph_scene->collapsed_groups.find(p_group);
 
-  std::ofstream file(fname);
+  if (it == this->graph_scene->collapsed_groups.end())
+    return;
 
-  if (!file.is_open())
-    throw std::runtime_error("Failed to open file: " + fname);
+  Logger::log()->trace("GraphViewer::expand_group: {}", p_group->get_caption());
 
-  file << "digraph root {\n";
-  file << "label=\"" << "GraphViewer::export_to_graphviz" << "\";\n";
-  file << "labelloc=\"t\";\n";
-  file << "rankdir=TD;\n";
-  file << "ranksep=0.5;\n";
-  file << "node [shape=record];\n";
+  CollapsedGroup &collapsed = *it->second;
+  NodeRecord     *p_summary = &collapsed.summary;
 
-  // Output nodes with their labels
-  for (QGraphicsItem *item : this->scene()->items())
-    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      file << p_node->get_id() << " [label=\"" << p_node->get_caption() << "("
-           << p_node->get_id() << ")" << "\"];\n";
+  // the members follow if the group has been moved in the meantime
+  const QPointF offset = this->get_collapsed_offset(p_summary);
 
-  for (QGraphicsItem *item : this->scene()->items())
-    if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
-      file << "\"" << p_link->get_node_out()->get_id() << "\" -> \""
-           << p_link->get_node_in()->get_id() << "\" [fontsize=8, label=\""
-           << p_link->get_node_out()->get_port_id(p_link->get_port_out_index()) << " - "
-           << p_link->get_node_in()->get_port_id(p_link->get_port_in_index()) << "\"]"
-           << std::endl;
+  if (p_summary->p_node)
+    this->release_node(p_summary);
 
-  file << "}\n";
-}
+  this->graph_scene->node_grid.remove(p_summary);
 
-GraphicsNode *GraphViewer::get_graphics_node_by_id(const std::string &node_id)
+  for (LinkRecord *p_link_record : p_summary->links)
+  {
+    if (p_link_record->node_out->p_summary == p_summary)
+      p_link_record->summary_port_out = -1;
+    if (p_link_record->node_in->p_summary == p_summary)
+      p_link_record->summary_port_in = -1;
+  }
+
+  for (NodeRecord *p_record : collapsed.members)
+  {
+    p_record->p_summary = nullptr;
+    p_record->pos += offset;
+
+    if (GraphicsNode *p_node = p_record->p_node)
+    {
+      p_node->setPos(p_record->pos);
+      p_node->setVisible(true);
+    }
+
+    this->graph_scene->node_grid.move(p_record, p_record->rect());
+
+    for (LinkRecord *p_link_record : p_record->links)
+      this->graph_scene->link_grid.move(p_link_record, p_link_record->rect());
+  }
+
+  this->graph_scene->collapsed_groups.erase(it);
+  p_group->set_is_collapsed(false);
+
+  // members and their links get their items back
+  this->update_items(true);
+}
+
+bool GraphViewer::export_graph(const std::string &fname)
+{
+  return this->export_graph(fname, graph_export_format_from_fname(fname));
+}
+
+bool GraphViewer::export_graph(const std::string &fname, GraphExportFormat format)
 {
-  auto items = scene()->items();
+  Logger::log()->trace("GraphViewer::export_graph: {}", fname);
 
-  for (QGraphicsItem *item : items)
-    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      if (p_node->get_id() == node_id)
-        return p_node;
+  // large stream buffer (set before opening the file), the writers never
+  // flush explicitly
+  std::vector<char> buffer(1 << 20);
+  std::ofstream     file;
+  file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  file.open(fname);
 
-  return nullptr;
+  if (!file.is_open())
+  {
+    Logger::log()->error("GraphViewer::export_graph: failed to open file: {}", fname);
+    return false;
+  }
+
+  std::unique_ptr<GraphWriter> p_writer = make_graph_writer(format, file);
+
+  p_writer->begin(this->graph_scene->id);
+
+  for (auto &[_, record] : this->graph_scene->node_records)
+  {
+    QPointF pos = record.p_node ? record.p_node->pos() : record.pos;
+
+    // hidden in a collapsed group, exported where they will be once expanded
+    if (record.p_summary)
+      pos += this->get_collapsed_offset(record.p_summary);
+
+    p_writer->write_node(record, pos);
+  }
+
+  for (auto &[p_record, _] : this->graph_scene->link_records)
+    p_writer->write_link(*p_record);
+
+  p_writer->end();
+
+  file.close();
+  return !file.fail();
+}
+
+bool GraphViewer::export_image(const std::string &fname, float scale, QRectF scene_rect)
+{
+  if (scene_rect.isEmpty())
+    scene_rect = this->get_bounding_box();
+
+  if (scene_rect.isEmpty() || scale <= 0.f)
+  {
+    Logger::log()->error("GraphViewer::export_image: empty area or invalid scale");
+    return false;
+  }
+
+  const QString suffix = QFileInfo(fname.c_str()).suffix().toLower();
+
+  if (suffix != "png" && suffix != "svg" && suffix != "pdf")
+  {
+    Logger::log()->error("GraphViewer::export_image: unsupported file format: {}",
+                         fname);
+    return false;
+  }
+
+  Logger::log()->trace("GraphViewer::export_image: {}, scale: {}", fname, scale);
+
+  // overlay items (toolbars of every view) are not part of the export
+  std::vector<QGraphicsItem *> hidden_items = {};
+
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
+    if (is_overlay_item(item) && item->isVisible())
+    {
+      item->setVisible(false);
+      hidden_items.push_back(item);
+    }
+
+  bool ret;
+
+  if (suffix == "svg" || suffix == "pdf")
+    ret = this->export_vector(fname, scale, scene_rect);
+  else
+    ret = this->export_png(fname, scale, scene_rect);
+
+  for (QGraphicsItem *item : hidden_items)
+    item->setVisible(true);
+
+  // items created for the export are released if out of view
+  this->update_items(true);
+
+  if (!ret)
+    Logger::log()->error("GraphViewer::export_image: failed to export {}", fname);
+
+  return ret;
+}
+
+bool GraphViewer::export_png(const std::string &fname,
+                             float              scale,
+                             const QRectF      &scene_rect)
+{
+  const int width = (int)std::ceil(scene_rect.width() * scale);
+  const int height = (int)std::ceil(scene_rect.height() * scale);
+  const int tile_size = std::max(16, GN_STYLE->viewer.export_tile_size);
+
+  PngStreamWriter writer(fname, width, height);
+
+  if (!writer.is_valid())
+    return false;
+
+  // the image is rendered by strips of tiles, each strip being written
+  // before the next one is rendered. For very wide images, the strip
+  // height is reduced to keep the buffer below 16 tiles
+  const int64_t budget = 16 * (int64_t)tile_size * tile_size; // pixels
+  const int     strip_height = (int)std::clamp(budget / width,
+                                           (int64_t)1,
+                                           (int64_t)tile_size);
+
+  QImage strip(width, strip_height, QImage::Format_ARGB32_Premultiplied);
+
+  for (int y = 0; y < height && writer.is_valid(); y += strip_height)
+  {
+    const int sh = std::min(strip_height, height - y);
+
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    for (int x = 0; x < width; x += tile_size)
+    {
+      const int tw = std::min(tile_size, width - x);
+
+      const QRectF target(x, 0, tw, sh);
+      const QRectF source(scene_rect.left() + x / scale,
+                          scene_rect.top() + y / scale,
+                          tw / scale,
+                          sh / scale);
+
+      this->render_scene_area(&painter, target, source);
+    }
+
+    painter.end();
+    writer.write_rows(strip, sh);
+  }
+
+  // with virtualization, the items materialized for the export are released
+  // at once, releasing them strip by strip would rebuild the ones straddling
+  // two strips and the ones of the viewport every time
+  if (GN_STYLE->viewer.virtualize_items)
+    this->update_items(true);
+
+  return writer.close();
+}
+
+void GraphViewer::export_to_graphviz(const std::string &fname)
+{
+  // after export: to convert, command line: dot export.dot -Tsvg > output.svg
+  if (!this->export_graph(fname, GraphExportFormat::DOT))
+    throw std::runtime_error("Failed to export file: " + fname);
+}
+
+bool GraphViewer::export_vector(const std::string &fname,
+                                float              scale,
+                                const QRectF      &scene_rect)
+{
+  const QSizeF size = scene_rect.size() * scale;
+  const QRectF target(QPointF(0.f, 0.f), size);
+
+  std::unique_ptr<QPaintDevice> p_device;
+
+  if (QFileInfo(fname.c_str()).suffix().toLower() == "svg")
+  {
+    auto p_svg = std::make_unique<QSvgGenerator>();
+    p_svg->setFileName(fname.c_str());
+    p_svg->setSize(size.toSize());
+    p_svg->setViewBox(target);
+    p_svg->setTitle(this->get_id().c_str());
+    p_device = std::move(p_svg);
+  }
+  else
+  {
+    // single page fitting the area, one point per pixel
+    auto p_pdf = std::make_unique<QPdfWriter>(QString(fname.c_str()));
+    p_pdf->setResolution(72);
+    p_pdf->setPageMargins(QMarginsF());
+    p_pdf->setPageSize(QPageSize(size, QPageSize::Point));
+    p_pdf->setTitle(this->get_id().c_str());
+    p_device = std::move(p_pdf);
+  }
+
+  QPainter painter;
+
+  if (!painter.begin(p_device.get()))
+    return false;
+
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setRenderHint(QPainter::TextAntialiasing);
+
+  // rendered at once, every item of the area is needed
+  this->render_scene_area(&painter, target, scene_rect);
+
+  return painter.end();
+}
+
+void GraphViewer::flush_changes()
+{
+  this->graph_scene->is_graph_changed_scheduled = false;
+
+  if (this->graph_scene->pending_changes.is_empty())
+    return;
+
+  // reset before emitting, the receivers may edit the graph in turn
+  ChangeSet changes = std::move(this->graph_scene->pending_changes);
+  this->graph_scene->pending_changes = ChangeSet();
+
+  Q_EMIT this->graph_scene->get_main_viewer()->graph_changed(changes);
+}
+
+void GraphViewer::flush_link_paths()
+{
+  std::unordered_set<GraphicsLink *> &pending = this->graph_scene->pending_link_paths;
+
+  if (pending.empty())
+    return;
+
+  std::vector<GraphicsLink *> links(pending.begin(), pending.end());
+  pending.clear();
+
+  this->update_link_paths(links);
+}
+
+void GraphViewer::flush_mouse_move()
+{
+  // processed before any other mouse event, to keep their order
+  if (std::unique_ptr<QMouseEvent> p_event = std::move(this->pending_mouse_move))
+    this->process_mouse_move(p_event.get());
+}
+
+GraphicsNode *GraphViewer::get_graphics_node_by_id(const std::string &node_id)
+{
+  NodeRecord *p_record = this->get_node_record(node_id);
+
+  // nodes without graphics item get one, it is released again later on
+  // if out of view
+  return p_record ? this->materialize_node(p_record) : nullptr;
 }
 
 QRectF GraphViewer::get_bounding_box()
@@ -685,7 +1769,7 @@ QRectF GraphViewer::get_bounding_box()
   {
     std::vector<QGraphicsItem *> items_not_static;
 
-    auto items = scene()->items();
+    auto items = get_scene_items(this->scene());
 
     for (QGraphicsItem *item : items)
     {
@@ -696,10 +1780,92 @@ QRectF GraphViewer::get_bounding_box()
     }
   }
 
+  // nodes without graphics item
+  const GraphScene *p_scene = this->graph_scene;
+
+  if (p_scene->materialized_nodes.size() < p_scene->node_records.size())
+    for (auto &[_, record] : this->graph_scene->node_records)
+      bbox = bbox.isNull() ? record.rect() : bbox.united(record.rect());
+
   return bbox;
 }
 
-std::string GraphViewer::get_id() const { return this->id; }
+QPointF GraphViewer::get_collapsed_offset(const NodeRecord *p_summary) const
+{
+  for (auto &[_, p_collapsed] : this->graph_scene->collapsed_groups)
+    if (&p_collapsed->summary == p_summary)
+    {
+      const QPointF pos = p_summary->p_node ? p_summary->p_node->pos() : p_summary->pos;
+      return pos - p_collapsed->origin;
+    }
+
+  return QPointF();
+}
+
+const ComputeEventLog &GraphViewer::get_compute_events() const
+{
+  return this->graph_scene->compute_events;
+}
+
+std::string GraphViewer::get_id() const { return this->graph_scene->id; }
+
+NodeHandle GraphViewer::get_node_handle(const std::string &node_id) const
+{
+  auto it = this->graph_scene->node_records.find(node_id);
+  return it != this->graph_scene->node_records.end() ? it->second.handle
+                                                     : NULL_NODE_HANDLE;
+}
+
+std::string GraphViewer::get_node_id(NodeHandle handle) const
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+  return p_record ? p_record->id : std::string();
+}
+
+LinkRecord *GraphViewer::get_link_record(GraphicsLink *p_link)
+{
+  // either end may be a collapsed group summary node, which has no
+  // record of its own
+  for (GraphicsNode *p_node : {p_link->get_node_out(), p_link->get_node_in()})
+  {
+    if (!p_node)
+      continue;
+
+    if (NodeRecord *p_node_record = this->get_node_record(p_node->get_id()))
+      for (LinkRecord *p_record : p_node_record->links)
+        if (p_record->p_link == p_link)
+          return p_record;
+  }
+
+  return nullptr;
+}
+
+LinkRecord *GraphViewer::get_link_record(NodeHandle node_out,
+                                         int        port_out,
+                                         NodeHandle node_in,
+                                         int        port_in) const
+{
+  NodeRecord *p_node_out = this->get_node_record(node_out);
+
+  if (!p_node_out)
+    return nullptr;
+
+  for (LinkRecord *p_record : p_node_out->links)
+    if (p_record->node_out == p_node_out && p_record->port_out == port_out &&
+        p_record->node_in->handle == node_in && p_record->port_in == port_in)
+      return p_record;
+
+  return nullptr;
+}
+
+LinkTelemetry GraphViewer::get_link_telemetry(NodeHandle node_out,
+                                              int        port_out,
+                                              NodeHandle node_in,
+                                              int        port_in) const
+{
+  LinkRecord *p_record = this->get_link_record(node_out, port_out, node_in, port_in);
+  return p_record ? p_record->telemetry : LinkTelemetry();
+}
 
 QPointF GraphViewer::get_mouse_scene_pos()
 {
@@ -709,42 +1875,142 @@ QPointF GraphViewer::get_mouse_scene_pos()
   return scene_pos;
 }
 
+NodeRecord *GraphViewer::get_node_record(const std::string &node_id)
+{
+  auto it = this->graph_scene->node_records.find(node_id);
+  return it != this->graph_scene->node_records.end() ? &it->second : nullptr;
+}
+
+NodeRecord *GraphViewer::get_node_record(NodeHandle handle) const
+{
+  auto it = this->graph_scene->handle_records.find(handle);
+  return it != this->graph_scene->handle_records.end() ? it->second : nullptr;
+}
+
+NodeTelemetry GraphViewer::get_node_telemetry(NodeHandle handle) const
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+  return p_record ? p_record->telemetry : NodeTelemetry();
+}
+
+int GraphViewer::get_port_index(NodeHandle handle, const std::string &port_id) const
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+  return p_record ? p_record->get_port_index(port_id) : -1;
+}
+
+std::string GraphViewer::get_port_id(NodeHandle handle, int port_index) const
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+
+  if (!p_record || !p_record->p_proxy)
+    return std::string();
+
+  return p_record->p_proxy->get_port_id(port_index);
+}
+
+std::vector<NodeHandle> GraphViewer::get_selected_node_handles() const
+{
+  std::vector<NodeHandle> handles = {};
+
+  for (auto &[handle, p_record] : this->graph_scene->handle_records)
+  {
+    const bool is_selected = p_record->p_node ? p_record->p_node->isSelected()
+                                              : p_record->is_selected;
+    if (is_selected)
+      handles.push_back(handle);
+  }
+
+  return handles;
+}
+
 std::vector<std::string> GraphViewer::get_selected_node_ids(
     std::vector<QPointF> *p_scene_pos_list)
 {
   std::vector<std::string> ids = {};
-  auto                     items = scene()->items();
 
-  for (QGraphicsItem *item : items)
-    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      if (p_node->isSelected())
-      {
-        ids.push_back(p_node->get_id());
+  for (auto &[nid, record] : this->graph_scene->node_records)
+  {
+    const bool is_selected = record.p_node ? record.p_node->isSelected()
+                                           : record.is_selected;
+    if (is_selected)
+    {
+      ids.push_back(nid);
 
-        // optional, returns node positions
-        if (p_scene_pos_list)
-          p_scene_pos_list->push_back(p_node->pos());
-      }
+      // optional, returns node positions
+      if (p_scene_pos_list)
+        p_scene_pos_list->push_back(record.p_node ? record.p_node->pos() : record.pos);
+    }
+  }
 
   return ids;
 }
 
+ViewerStats GraphViewer::get_stats() const
+{
+  ViewerStats       stats = this->frame_stats;
+  const GraphScene *p_scene = this->graph_scene;
+
+  // items
+  stats.nodes = p_scene->materialized_nodes.size();
+  stats.links = p_scene->materialized_links.size();
+  stats.node_records = p_scene->node_records.size();
+  stats.link_records = p_scene->link_records.size();
+
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
+    if (dynamic_cast<GraphicsGroup *>(item))
+      stats.groups++;
+    else if (dynamic_cast<GraphicsComment *>(item))
+      stats.comments++;
+
+  // cumulated counters
+  const RuntimeCounters *p_counters = GN_COUNTERS;
+
+  stats.link_path_rebuilds = p_counters->link_path_rebuilds;
+  stats.geometry_computations = p_counters->geometry_computations;
+  stats.scene_scans = p_counters->scene_scans;
+  stats.signal_emissions = p_scene->get_main_viewer()->signal_emissions;
+
+  auto hit_rate = [](uint64_t hits, uint64_t misses)
+  { return hits + misses > 0 ? float(hits) / float(hits + misses) : 0.f; };
+
+  stats.geometry_cache_hit_rate = hit_rate(p_counters->geometry_cache_hits,
+                                           p_counters->geometry_computations);
+  stats.thumbnail_cache_hit_rate = hit_rate(p_scene->thumbnail_cache->get_hit_count(),
+                                            p_scene->thumbnail_cache->get_miss_count());
+
+  return stats;
+}
+
+bool GraphViewer::is_in_active_area(const QRectF &rect) const
+{
+  for (GraphViewer *p_viewer : this->graph_scene->get_viewers())
+    if (p_viewer->active_rect.intersects(rect))
+      return true;
+
+  return false;
+}
+
 bool GraphViewer::is_item_static(QGraphicsItem *item)
 {
-  return !(std::find(this->static_items.begin(), this->static_items.end(), item) ==
-           this->static_items.end());
+  // static items of any view sharing the scene
+  return is_overlay_item(item);
 }
 
 void GraphViewer::json_from(nlohmann::json json, bool clear_existing_content)
 {
+  LinkPathBatch link_path_batch(this);
+
   // generate graph from json data
   if (clear_existing_content)
   {
     this->clear();
-    this->id = json["id"];
-    this->current_link_type = json["current_link_type"].get<LinkType>();
+    this->graph_scene->id = json["id"];
+    this->graph_scene->current_link_type = json["current_link_type"].get<LinkType>();
   }
 
+  std::vector<GraphicsGroup *> groups_to_collapse = {};
+
   if (!json["groups"].is_null())
   {
     for (auto &json_group : json["groups"])
@@ -752,6 +2018,9 @@ void GraphViewer::json_from(nlohmann::json json, bool clear_existing_content)
       GraphicsGroup *p_group = new GraphicsGroup();
       this->add_item(p_group);
       p_group->json_from(json_group);
+
+      if (json_group.value("is_collapsed", false))
+        groups_to_collapse.push_back(p_group);
     }
   }
 
@@ -797,10 +2066,26 @@ void GraphViewer::json_from(nlohmann::json json, bool clear_existing_content)
       // outter headless nodes manager. THERE IS NO NODE FACTORY AVAILABLE
       Q_EMIT this->new_graphics_node_request(nid, QPointF(x, y));
 
-      this->get_graphics_node_by_id(nid)->json_from(json_node);
+      NodeRecord *p_record = this->get_node_record(nid);
+
+      if (!p_record)
+      {
+        Logger::log()->error(
+            "GraphViewer::json_from: node instance cannot be found, ID: {}",
+            nid);
+        continue;
+      }
+
+      if (p_record->p_node)
+        p_record->p_node->json_from(json_node);
+      else
+      {
+        p_record->json_from(json_node);
+        this->graph_scene->node_grid.move(p_record, p_record->rect());
+      }
 
       Logger::log()->trace("{}", json_node["caption"].get<std::string>());
-      Logger::log()->trace("{}", this->get_graphics_node_by_id(nid)->get_nports());
+      Logger::log()->trace("{}", p_record->p_proxy->get_nports());
     }
   }
 
@@ -832,27 +2117,51 @@ void GraphViewer::json_from(nlohmann::json json, bool clear_existing_content)
       this->add_link(node_out_id, port_out_id, node_in_id, port_in_id);
     }
   }
+
+  // collapsed last, once their content is there
+  for (GraphicsGroup *p_group : groups_to_collapse)
+    this->collapse_group(p_group);
 }
 
 nlohmann::json GraphViewer::json_to() const
 {
   nlohmann::json json;
 
-  json["id"] = this->id;
-  json["current_link_type"] = this->current_link_type;
+  json["id"] = this->graph_scene->id;
+  json["current_link_type"] = this->graph_scene->current_link_type;
 
   std::vector<nlohmann::json> json_node_list = {};
   std::vector<nlohmann::json> json_link_list = {};
   std::vector<nlohmann::json> json_group_list = {};
   std::vector<nlohmann::json> json_comment_list = {};
 
-  for (QGraphicsItem *item : this->scene()->items())
+  // nodes and links from the records, with or without graphics item
+  for (auto &[_, record] : this->graph_scene->node_records)
   {
-    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      json_node_list.push_back(p_node->json_to());
-    else if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
-      json_link_list.push_back(p_link->json_to());
-    else if (GraphicsGroup *p_group = dynamic_cast<GraphicsGroup *>(item))
+    nlohmann::json json_node = record.p_node ? record.p_node->json_to()
+                                             : record.json_to();
+
+    // hidden in a collapsed group, saved where they will be once expanded
+    if (record.p_summary)
+    {
+      const QPointF offset = this->get_collapsed_offset(record.p_summary);
+      json_node["scene_position.x"] = json_node["scene_position.x"].get<float>() +
+                                      offset.x();
+      json_node["scene_position.y"] = json_node["scene_position.y"].get<float>() +
+                                      offset.y();
+    }
+
+    json_node_list.push_back(json_node);
+  }
+
+  // not from the graphics links, they may be rerouted to a collapsed
+  // group summary node
+  for (auto &[p_record, _] : this->graph_scene->link_records)
+    json_link_list.push_back(p_record->json_to(this->graph_scene->current_link_type));
+
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
+  {
+    if (GraphicsGroup *p_group = dynamic_cast<GraphicsGroup *>(item))
       json_group_list.push_back(p_group->json_to());
     else if (GraphicsComment *p_comment = dynamic_cast<GraphicsComment *>(item))
       json_comment_list.push_back(p_comment->json_to());
@@ -873,7 +2182,8 @@ void GraphViewer::keyPressEvent(QKeyEvent *event)
 
   if (event->key() == Qt::Key_Delete)
   {
-    this->delete_selected_items();
+    if (!this->is_busy())
+      this->delete_selected_items();
     event->accept();
     return;
   }
@@ -899,7 +2209,8 @@ void GraphViewer::keyReleaseEvent(QKeyEvent *event)
     if (id_list.size())
       Q_EMIT this->nodes_copy_request(id_list, scene_pos_list);
   }
-  else if (event->modifiers() == Qt::ControlModifier && event->key() == Qt::Key_D)
+  else if (event->modifiers() == Qt::ControlModifier && event->key() == Qt::Key_D &&
+           !this->is_busy())
   {
     std::vector<QPointF>     scene_pos_list = {};
     std::vector<std::string> id_list = this->get_selected_node_ids(&scene_pos_list);
@@ -945,7 +2256,8 @@ void GraphViewer::keyReleaseEvent(QKeyEvent *event)
   {
     Q_EMIT this->graph_save_request();
   }
-  else if (event->modifiers() == Qt::ControlModifier && event->key() == Qt::Key_V)
+  else if (event->modifiers() == Qt::ControlModifier && event->key() == Qt::Key_V &&
+           !this->is_busy())
   {
     Q_EMIT this->nodes_paste_request();
   }
@@ -953,61 +2265,237 @@ void GraphViewer::keyReleaseEvent(QKeyEvent *event)
   QGraphicsView::keyReleaseEvent(event);
 }
 
-void GraphViewer::mouseMoveEvent(QMouseEvent *event)
+void GraphViewer::materialize_area(const QRectF &rect)
 {
-  // temporary link follows the mouse
-  if (this->temp_link)
-  {
-    // Update the end of the temporary cubic spline to follow the mouse
-    QPointF end_pos = this->mapToScene(event->pos());
-    this->temp_link->set_endpoints(this->temp_link->path().pointAtPercent(0), end_pos);
-    this->temp_link->update_path();
-  }
+  if (!GN_STYLE->viewer.virtualize_items)
+    return;
 
-  QGraphicsView::mouseMoveEvent(event);
+  std::vector<NodeRecord *> nodes;
+  std::vector<LinkRecord *> links;
+  this->graph_scene->node_grid.query(rect, nodes);
+  this->graph_scene->link_grid.query(rect, links);
+
+  LinkPathBatch link_path_batch(this);
+
+  for (NodeRecord *p_record : nodes)
+    if (!p_record->p_summary && rect.intersects(p_record->rect()))
+      this->materialize_node(p_record);
+
+  for (LinkRecord *p_record : links)
+    if (rect.intersects(p_record->rect()))
+      this->materialize_link(p_record);
 }
 
-void GraphViewer::mousePressEvent(QMouseEvent *event)
+GraphicsLink *GraphViewer::materialize_link(LinkRecord *p_record)
 {
-  if (event->button() == Qt::RightButton)
-  {
-    QGraphicsItem *item = this->itemAt(event->pos());
+  if (p_record->p_link)
+    return p_record->p_link;
 
-    if ((event->modifiers() & Qt::ControlModifier) && item)
-    {
-      // Ctrl + Right-Click on a link or a node to remove it
-      if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
-        this->delete_graphics_link(p_link);
-      else if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-        this->delete_graphics_node(p_node);
-      else if (GraphicsComment *p_comment = dynamic_cast<GraphicsComment *>(item))
-        clean_delete_graphics_item(p_comment);
+  // internal to a collapsed group
+  if (p_record->is_hidden())
+    return nullptr;
 
-      // prevent context menu opening
-      this->setContextMenuPolicy(Qt::NoContextMenu);
+  // both ends are needed, possibly rerouted to a group summary node
+  const int     port_out = p_record->get_shown_port_out();
+  const int     port_in = p_record->get_shown_port_in();
+  GraphicsNode *from_node = this->materialize_node(p_record->get_shown_node_out());
+  GraphicsNode *to_node = this->materialize_node(p_record->get_shown_node_in());
 
-      // this is ugly... set context menu back
-      QTimer::singleShot(200,
-                         this,
-                         [this]()
-                         { this->setContextMenuPolicy(Qt::DefaultContextMenu); });
+  if (!from_node || !to_node)
+    return nullptr;
 
-      event->accept();
-      return;
-    }
+  QColor color = get_color_from_data_type(from_node->get_data_type(port_out));
 
-    QToolTip::hideText();
-  }
+  GraphicsLink *p_link = this->acquire_link(color, this->graph_scene->current_link_type);
 
-  if (event->button() == Qt::LeftButton)
-  {
-    if (event->modifiers() & Qt::ShiftModifier)
-    {
-      this->setDragMode(QGraphicsView::RubberBandDrag);
-      Q_EMIT this->rubber_band_selection_started();
-    }
-    else
-    {
+  p_link->set_pen_style(Qt::SolidLine);
+  p_link->set_endnodes(from_node, port_out, to_node, port_in);
+
+  if (this->graph_scene->link_path_batch_depth > 0)
+    this->graph_scene->pending_link_paths.insert(p_link);
+  else
+    p_link->update_path();
+
+  p_link->set_is_critical(p_record->is_critical &&
+                          this->graph_scene->telemetry_overlay.is_critical_path_visible);
+  p_link->set_telemetry(&p_record->telemetry);
+
+  // mark those ports as connected
+  from_node->set_is_port_connected(port_out, p_link);
+  to_node->set_is_port_connected(port_in, p_link);
+
+  this->scene()->addItem(p_link);
+
+  p_record->p_link = p_link;
+  this->graph_scene->materialized_links.insert(p_record);
+
+  return p_link;
+}
+
+GraphicsNode *GraphViewer::materialize_node(NodeRecord *p_record)
+{
+  if (p_record->p_node)
+    return p_record->p_node;
+
+  if (!p_record->p_proxy)
+  {
+    Logger::log()->error("GraphViewer::materialize_node: proxy of node {} is gone",
+                         p_record->id);
+    return nullptr;
+  }
+
+  GraphicsNode *p_node = this->acquire_node(p_record->p_proxy);
+  this->add_item(p_node);
+
+  // restore the state kept by the record, before the callbacks are set
+  // so that this goes unnoticed
+  p_node->json_from(p_record->json_to());
+  p_node->setSelected(p_record->is_selected);
+  p_node->set_is_node_pinned(p_record->is_pinned);
+  p_node->set_data_version(p_record->data_version);
+
+  p_node->set_compute_state(p_record->compute_state);
+  p_node->set_telemetry(&p_record->telemetry);
+
+  if (p_record->widget_factory)
+    p_node->set_widget_factory(p_record->widget_factory, p_record->widget_size.toSize());
+
+  // created on demand while hidden in a collapsed group
+  if (p_record->p_summary)
+    p_node->setVisible(false);
+
+  p_record->p_node = p_node;
+  this->graph_scene->materialized_nodes.insert(p_record);
+  this->sync_node_record(p_record);
+
+  // collapsed group summary nodes are not known by the host, no
+  // interaction is forwarded and there is no data to preview
+  if (p_record->is_summary)
+    return p_node;
+
+  p_node->set_thumbnail_cache(this->graph_scene->thumbnail_cache);
+
+  // interactions are reported by the main viewer, whichever view
+  // created the item (see setup_node_callbacks)
+  p_node->set_callbacks(&this->graph_scene->node_callbacks);
+
+  // the host usually sets the node widget right after, the widgets
+  // visibility is checked once everything is in place
+  this->schedule_widgets_update();
+
+  return p_node;
+}
+
+MemoryReport GraphViewer::memory_report() const
+{
+  MemoryReport      report;
+  const GraphScene *p_scene = this->graph_scene;
+
+  const size_t node_overhead = 2 * sizeof(void *); // hash table node and bucket
+
+  auto heap_size = [](const std::string &str)
+  { return str.capacity() >= sizeof(std::string) ? str.capacity() + 1 : 0; };
+
+  // graphics items
+  std::unordered_set<const GraphicsNodeGeometry *> geometries = {};
+
+  for (const NodeRecord *p_record : p_scene->materialized_nodes)
+  {
+    const GraphicsNodeGeometry *p_geometry = &p_record->p_node->get_geometry();
+
+    if (geometries.insert(p_geometry).second)
+      report.node_geometries += p_geometry->get_memory_usage();
+
+    report.graphics_nodes += p_record->p_node->get_memory_usage();
+    report.graphics_nodes_count++;
+  }
+
+  for (const LinkRecord *p_record : p_scene->materialized_links)
+  {
+    report.graphics_links += p_record->p_link->get_memory_usage();
+    report.graphics_links_count++;
+  }
+
+  // records
+  for (auto &[nid, record] : p_scene->node_records)
+    report.node_records += sizeof(std::pair<std::string, NodeRecord>) + node_overhead +
+                           heap_size(nid) + heap_size(record.id) +
+                           record.links.capacity() * sizeof(LinkRecord *) +
+                           sizeof(std::pair<NodeHandle, NodeRecord *>) + node_overhead;
+
+  report.link_records = p_scene->link_records.size() *
+                        (sizeof(LinkRecord) + sizeof(LinkRecord *) +
+                         sizeof(std::unique_ptr<LinkRecord>) + node_overhead);
+
+  report.spatial_indexes = p_scene->node_grid.get_memory_usage() +
+                           p_scene->link_grid.get_memory_usage();
+
+  report.thumbnails = p_scene->thumbnail_cache->get_memory_usage();
+
+  return report;
+}
+
+void GraphViewer::mouseMoveEvent(QMouseEvent *event)
+{
+  // only the last move of the frame is processed, panning and items
+  // dragging catch up with the total displacement at once
+  if (GN_STYLE->viewer.coalesce_input)
+  {
+    this->pending_mouse_move.reset(static_cast<QMouseEvent *>(event->clone()));
+    this->schedule_frame();
+    event->accept();
+    return;
+  }
+
+  this->process_mouse_move(event);
+}
+
+void GraphViewer::mousePressEvent(QMouseEvent *event)
+{
+  this->flush_mouse_move();
+
+  if (event->button() == Qt::RightButton)
+  {
+    QGraphicsItem *item = this->itemAt(event->pos());
+
+    if ((event->modifiers() & Qt::ControlModifier) && item)
+    {
+      // Ctrl + Right-Click on a link or a node to remove it, not while busy
+      if (!this->is_busy())
+      {
+        if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
+          this->delete_graphics_link(p_link);
+        else if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
+          this->delete_graphics_node(p_node);
+        else if (GraphicsComment *p_comment = dynamic_cast<GraphicsComment *>(item))
+          clean_delete_graphics_item(p_comment);
+      }
+
+      // prevent context menu opening
+      this->setContextMenuPolicy(Qt::NoContextMenu);
+
+      // this is ugly... set context menu back
+      QTimer::singleShot(200,
+                         this,
+                         [this]()
+                         { this->setContextMenuPolicy(Qt::DefaultContextMenu); });
+
+      event->accept();
+      return;
+    }
+
+    QToolTip::hideText();
+  }
+
+  if (event->button() == Qt::LeftButton)
+  {
+    if (event->modifiers() & Qt::ShiftModifier)
+    {
+      this->setDragMode(QGraphicsView::RubberBandDrag);
+      Q_EMIT this->rubber_band_selection_started();
+    }
+    else
+    {
       this->setDragMode(QGraphicsView::ScrollHandDrag);
     }
   }
@@ -1017,6 +2505,8 @@ void GraphViewer::mousePressEvent(QMouseEvent *event)
 
 void GraphViewer::mouseReleaseEvent(QMouseEvent *event)
 {
+  this->flush_mouse_move();
+
   this->setDragMode(QGraphicsView::NoDrag);
   Q_EMIT this->rubber_band_selection_finished();
   QGraphicsView::mouseReleaseEvent(event);
@@ -1024,23 +2514,41 @@ void GraphViewer::mouseReleaseEvent(QMouseEvent *event)
 
 void GraphViewer::on_compute_finished(const std::string &node_id)
 {
-  this->get_graphics_node_by_id(node_id)->on_compute_finished();
+  if (NodeRecord *p_record = this->get_node_record(node_id))
+    this->on_compute_finished_by_handle(p_record->handle);
+}
+
+void GraphViewer::on_compute_finished_by_handle(NodeHandle handle)
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+
+  if (p_record)
+    this->apply_compute_state(p_record, ComputeState::DONE, true);
 }
 
 void GraphViewer::on_compute_started(const std::string &node_id)
 {
-  this->get_graphics_node_by_id(node_id)->on_compute_started();
+  if (NodeRecord *p_record = this->get_node_record(node_id))
+    this->on_compute_started_by_handle(p_record->handle);
+}
+
+void GraphViewer::on_compute_started_by_handle(NodeHandle handle)
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+
+  if (p_record)
+    this->apply_compute_state(p_record, ComputeState::RUNNING, true);
 }
 
 void GraphViewer::on_connection_dropped(GraphicsNode *from,
                                         int           port_index,
                                         QPointF       scene_pos)
 {
-  if (this->temp_link)
+  if (this->graph_scene->temp_link)
   {
     // Remove the temporary line
-    clean_delete_graphics_item(this->temp_link);
-    this->temp_link = nullptr;
+    this->recycle_link(this->graph_scene->temp_link);
+    this->graph_scene->temp_link = nullptr;
 
     Logger::log()->trace("GraphViewer::on_connection_dropped connection_dropped {}:{}",
                          from->get_id(),
@@ -1057,41 +2565,36 @@ void GraphViewer::on_connection_finished(GraphicsNode *from_node,
                                          GraphicsNode *to_node,
                                          int           port_to_index)
 {
-  if (this->temp_link)
+  if (this->graph_scene->temp_link)
   {
     PortType from_type = from_node->get_port_type(port_from_index);
     PortType to_type = to_node->get_port_type(port_to_index);
 
-    if (from_node != to_node && from_type != to_type)
+    // no record for collapsed group summary nodes, they cannot be
+    // connected
+    NodeRecord *p_from_record = this->get_node_record(from_node->get_id());
+    NodeRecord *p_to_record = this->get_node_record(to_node->get_id());
+
+    if (p_from_record && p_to_record && from_node != to_node && from_type != to_type)
     {
-      // remove any existing connection linked to the node 'to' input
-      if (!to_node->is_port_available(port_to_index))
-      {
-        Logger::log()->trace("GraphViewer::on_connection_finished: replace connection");
-
-        // loop over all graphics
-        GraphicsLink *p_link_to_delete = nullptr;
-
-        for (QGraphicsItem *item : this->scene()->items())
-          if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
-            if (p_link != this->temp_link)
-            {
-              std::string link_node_id = p_link->get_node_in()->get_id();
-              int         link_port_index = p_link->get_port_in_index();
-
-              if (link_node_id == to_node->get_id() && link_port_index == port_to_index)
-              {
-                p_link_to_delete = p_link;
-                break;
-              }
-            }
-
-        // delete the link but prevent the graph update since it's
-        // going to be updated after the new link will trigger an
-        // update in the next step
-        bool link_will_be_replaced = true;
-        this->delete_graphics_link(p_link_to_delete, link_will_be_replaced);
-      }
+      // remove any existing connection linked to the input, found from
+      // the records since its graphics link may have been released
+      const bool  is_from_in = from_type == PortType::IN;
+      NodeRecord *p_in_record = is_from_in ? p_from_record : p_to_record;
+      int         port_in_index = is_from_in ? port_from_index : port_to_index;
+
+      for (LinkRecord *p_record : p_in_record->links)
+        if (p_record->node_in == p_in_record && p_record->port_in == port_in_index)
+        {
+          Logger::log()->trace("GraphViewer::on_connection_finished: replace connection");
+
+          // delete the link but prevent the graph update since it's
+          // going to be updated after the new link will trigger an
+          // update in the next step
+          bool link_will_be_replaced = true;
+          this->delete_link_record(p_record, link_will_be_replaced);
+          break;
+        }
 
       // create new link
       if (from_node->is_port_available(port_from_index) &&
@@ -1106,24 +2609,33 @@ void GraphViewer::on_connection_finished(GraphicsNode *from_node,
         QPointF port_to_pos = to_node->scenePos() +
                               to_node->get_geometry().port_rects[port_to_index].center();
 
-        this->temp_link->set_endpoints(port_from_pos, port_to_pos);
-        this->temp_link->set_pen_style(Qt::SolidLine);
+        this->graph_scene->temp_link->set_endpoints(port_from_pos, port_to_pos);
+        this->graph_scene->temp_link->set_pen_style(Qt::SolidLine);
 
         // from output to input
         {
-          this->temp_link->set_endnodes(from_node,
+          this->graph_scene->temp_link->set_endnodes(from_node,
                                         port_from_index,
                                         to_node,
                                         port_to_index);
 
-          GraphicsNode *node_out = this->temp_link->get_node_out();
-          GraphicsNode *node_in = this->temp_link->get_node_in();
+          GraphicsNode *node_out = this->graph_scene->temp_link->get_node_out();
+          GraphicsNode *node_in = this->graph_scene->temp_link->get_node_in();
+
+          int port_out = this->graph_scene->temp_link->get_port_out_index();
+          int port_in = this->graph_scene->temp_link->get_port_in_index();
 
-          int port_out = this->temp_link->get_port_out_index();
-          int port_in = this->temp_link->get_port_in_index();
+          node_out->set_is_port_connected(port_out, this->graph_scene->temp_link);
+          node_in->set_is_port_connected(port_in, this->graph_scene->temp_link);
 
-          node_out->set_is_port_connected(port_out, this->temp_link);
-          node_in->set_is_port_connected(port_in, this->temp_link);
+          LinkRecord *p_record = this->add_link_record(
+              this->get_node_record(node_out->get_id()),
+              port_out,
+              this->get_node_record(node_in->get_id()),
+              port_in);
+
+          p_record->p_link = this->graph_scene->temp_link;
+          this->graph_scene->materialized_links.insert(p_record);
 
           Logger::log()->trace("GraphViewer::on_connection_finished, {}:{} -> {}:{}",
                                node_out->get_id(),
@@ -1135,35 +2647,48 @@ void GraphViewer::on_connection_finished(GraphicsNode *from_node,
                                            node_out->get_port_id(port_out),
                                            node_in->get_id(),
                                            node_in->get_port_id(port_in));
+
+          Q_EMIT this->connection_finished_by_handle(p_record->node_out->handle,
+                                                     port_out,
+                                                     p_record->node_in->handle,
+                                                     port_in);
         }
 
         // Keep the link as a permanent connection
-        this->temp_link = nullptr;
+        this->graph_scene->temp_link = nullptr;
+      }
+      else
+      {
+        this->recycle_link(this->graph_scene->temp_link);
+        this->graph_scene->temp_link = nullptr;
       }
     }
     else
     {
       // tried to connect but nothinh happens (same node from and to,
       // same port types...)
-      clean_delete_graphics_item(temp_link);
+      this->recycle_link(this->graph_scene->temp_link);
+      this->graph_scene->temp_link = nullptr;
     }
   }
 
-  this->source_node = nullptr;
+  this->graph_scene->source_node = nullptr;
 }
 
 void GraphViewer::on_connection_started(GraphicsNode *from_node, int port_index)
 {
-  this->source_node = from_node;
+  this->graph_scene->source_node = from_node;
 
   QColor color = get_color_from_data_type(from_node->get_data_type(port_index));
-  this->temp_link = new GraphicsLink(color, this->current_link_type);
+  this->graph_scene->temp_link = this->acquire_link(
+      color,
+      this->graph_scene->current_link_type);
 
   QPointF port_pos = from_node->scenePos() +
                      from_node->get_geometry().port_rects[port_index].center();
 
-  this->temp_link->set_endpoints(port_pos, port_pos);
-  this->scene()->addItem(this->temp_link);
+  this->graph_scene->temp_link->set_endpoints(port_pos, port_pos);
+  this->scene()->addItem(this->graph_scene->temp_link);
 
   Q_EMIT this->connection_started(from_node->get_id(),
                                   from_node->get_port_id(port_index));
@@ -1186,36 +2711,299 @@ void GraphViewer::on_node_right_clicked(const std::string &node_id, QPointF scen
   Q_EMIT this->node_right_clicked(node_id, scene_pos);
 }
 
+void GraphViewer::on_signal_emitted() { this->signal_emissions++; }
+
 void GraphViewer::on_update_finished()
 {
   if (GN_STYLE->viewer.disable_during_update)
-    this->set_enabled(true);
+    this->set_busy(false);
 
   this->setCursor(Qt::ArrowCursor);
+
+  if (this->graph_scene->telemetry_overlay.is_critical_path_visible)
+    Q_EMIT this->critical_path_updated(this->compute_critical_path());
 }
 
 void GraphViewer::on_update_started()
 {
-  this->setCursor(Qt::WaitCursor);
+  this->graph_scene->pass_start_time = get_time_ns();
+
+  // the graph can still be browsed, not a wait cursor
+  this->setCursor(Qt::BusyCursor);
 
   if (GN_STYLE->viewer.disable_during_update)
-    this->set_enabled(false);
+    this->set_busy(true);
+}
+
+void GraphViewer::paintEvent(QPaintEvent *event)
+{
+  const RuntimeCounters before = *GN_COUNTERS;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QGraphicsView::paintEvent(event);
+
+  // figures of this frame only
+  const RuntimeCounters *p_after = GN_COUNTERS;
+
+  this->frame_stats.frame_time = 1e-6f * timer.nsecsElapsed();
+  this->frame_stats.frame_count++;
+  this->frame_stats.node_paints = p_after->node_paints - before.node_paints;
+  this->frame_stats.link_paints = p_after->link_paints - before.link_paints;
+  this->frame_stats.group_paints = p_after->group_paints - before.group_paints;
+  this->frame_stats.comment_paints = p_after->comment_paints - before.comment_paints;
+}
+
+void GraphViewer::process_commands()
+{
+  GraphScene *p_scene = this->graph_scene;
+
+  // cleared first, anything pushed from now on schedules another drain
+  p_scene->is_command_drain_scheduled = false;
+
+  const int     budget = GN_STYLE->viewer.max_commands_per_frame;
+  int           count = 0;
+  ViewerCommand command;
+
+  while ((budget <= 0 || count < budget) && p_scene->command_queue->try_pop(command))
+  {
+    this->apply_command(command);
+    count++;
+  }
+
+  // then the overflow, pushed after everything in the queue. Taken by batch to
+  // keep the producers waiting on the lock as little as possible
+  if ((budget <= 0 || count < budget) && p_scene->has_spilled_commands)
+  {
+    std::vector<ViewerCommand> commands;
+
+    {
+      std::lock_guard<std::mutex> lock(p_scene->spilled_commands_mutex);
+      std::deque<ViewerCommand>  &spilled = p_scene->spilled_commands;
+
+      const size_t n = budget <= 0 ? spilled.size()
+                                   : std::min(spilled.size(), (size_t)(budget - count));
+
+      commands.assign(spilled.begin(), spilled.begin() + n);
+      spilled.erase(spilled.begin(), spilled.begin() + n);
+
+      if (spilled.empty())
+        p_scene->has_spilled_commands = false;
+    }
+
+    for (const ViewerCommand &spilled_command : commands)
+      this->apply_command(spilled_command);
+
+    count += (int)commands.size();
+  }
+
+  // possibly more left, continued next frame without waiting for a push
+  if (budget > 0 && count == budget)
+  {
+    p_scene->is_command_drain_scheduled = true;
+    this->schedule_frame();
+  }
+}
+
+void GraphViewer::process_frame()
+{
+  this->frame_clock.start();
+
+  if (this == this->graph_scene->get_main_viewer())
+    this->process_commands();
+
+  // compute status changes, a single repaint whatever their number
+  if (this->is_compute_repaint_pending)
+  {
+    this->is_compute_repaint_pending = false;
+    this->viewport()->update();
+  }
+
+  this->flush_mouse_move();
+
+  if (this->pending_zoom_log != 0.f)
+  {
+    // all at once, or eased over the next frames
+    float step = this->pending_zoom_log;
+
+    if (GN_STYLE->viewer.smooth_zoom && std::abs(step) > 1e-3f)
+      step *= GN_STYLE->viewer.smooth_zoom_rate;
+
+    this->pending_zoom_log -= step;
+    this->apply_zoom(std::exp(step), this->zoom_anchor_pos);
+
+    if (this->pending_zoom_log != 0.f)
+      this->schedule_frame();
+  }
+}
+
+void GraphViewer::process_mouse_move(QMouseEvent *event)
+{
+  // panning the view (dragging with no item grabbing the mouse)
+  if (this->dragMode() == QGraphicsView::ScrollHandDrag &&
+      (event->buttons() & Qt::LeftButton) && !this->scene()->mouseGrabberItem())
+  {
+    this->start_navigation();
+    this->schedule_items_update();
+  }
+
+  // temporary link follows the mouse
+  if (this->graph_scene->temp_link)
+  {
+    // Update the end of the temporary cubic spline to follow the mouse
+    QPointF end_pos = this->mapToScene(event->pos());
+    GraphicsLink *p_temp_link = this->graph_scene->temp_link;
+    p_temp_link->set_endpoints(p_temp_link->path().pointAtPercent(0), end_pos);
+    p_temp_link->update_path();
+  }
+
+  QGraphicsView::mouseMoveEvent(event);
+}
+
+bool GraphViewer::push_command(const ViewerCommand &command)
+{
+  GraphScene *p_scene = this->graph_scene;
+  bool        is_queued = false;
+
+  // the queue only takes commands as long as nothing is waiting in the overflow
+  // list, otherwise they would be applied before older ones
+  if (!p_scene->has_spilled_commands)
+    is_queued = p_scene->command_queue->try_push(command);
+
+  if (!is_queued)
+  {
+    std::lock_guard<std::mutex> lock(p_scene->spilled_commands_mutex);
+
+    if (!p_scene->has_spilled_commands.exchange(true))
+      Logger::log()->warn("GraphViewer::push_command: queue full, commands spilled");
+
+    p_scene->spilled_commands.push_back(command);
+  }
+
+  // a single wake up of the GUI thread per batch, not per command
+  if (!p_scene->is_command_drain_scheduled.exchange(true))
+  {
+    GraphViewer *p_main = p_scene->get_main_viewer();
+    QMetaObject::invokeMethod(
+        p_main,
+        [p_main]() { p_main->schedule_frame(); },
+        Qt::QueuedConnection);
+  }
+
+  return is_queued;
+}
+
+void GraphViewer::recycle_link(GraphicsLink *p_link)
+{
+  if (!p_link)
+    return;
+
+  if (p_link->scene())
+    p_link->scene()->removeItem(p_link);
+
+  this->graph_scene->pending_link_paths.erase(p_link);
+
+  std::vector<GraphicsLink *> &pool = this->graph_scene->link_pool;
+
+  if ((int)pool.size() >= GN_STYLE->viewer.max_pooled_items)
+  {
+    delete p_link;
+    return;
+  }
+
+  // lets go of the nodes right away, not when reused
+  p_link->reset(QColor(0, 0, 0, 0), this->graph_scene->current_link_type);
+  pool.push_back(p_link);
+}
+
+void GraphViewer::recycle_node(GraphicsNode *p_node)
+{
+  if (!p_node)
+    return;
+
+  if (p_node->scene())
+    p_node->scene()->removeItem(p_node);
+
+  std::vector<GraphicsNode *> &pool = this->graph_scene->node_pool;
+
+  if ((int)pool.size() >= GN_STYLE->viewer.max_pooled_items)
+  {
+    delete p_node;
+    return;
+  }
+
+  // widget and proxy released right away, not when reused
+  p_node->reset(nullptr);
+  pool.push_back(p_node);
+}
+
+void GraphViewer::release_link(LinkRecord *p_record)
+{
+  GraphicsLink *p_link = p_record->p_link;
+  NodeRecord   *p_node_out = p_record->get_shown_node_out();
+  NodeRecord   *p_node_in = p_record->get_shown_node_in();
+
+  if (p_node_out->p_node)
+    p_node_out->p_node->set_is_port_connected(p_record->get_shown_port_out(), nullptr);
+  if (p_node_in->p_node)
+    p_node_in->p_node->set_is_port_connected(p_record->get_shown_port_in(), nullptr);
+
+  this->recycle_link(p_link);
+
+  p_record->p_link = nullptr;
+  this->graph_scene->materialized_links.erase(p_record);
+}
+
+void GraphViewer::release_node(NodeRecord *p_record)
+{
+  GraphicsNode *p_node = p_record->p_node;
+
+  // links first, they refer to the node
+  for (LinkRecord *p_link_record : p_record->links)
+    if (p_link_record->p_link)
+      this->release_link(p_link_record);
+
+  this->sync_node_record(p_record);
+
+  // silent removal, the node is not deselected from the user standpoint
+  p_node->set_callbacks(nullptr);
+
+  if (p_node->is_widget_live())
+    p_node->set_widget_live(false);
+
+  this->graph_scene->live_widget_nodes.remove(p_node);
+  this->recycle_node(p_node);
+
+  p_record->p_node = nullptr;
+  this->graph_scene->materialized_nodes.erase(p_record);
 }
 
 void GraphViewer::remove_node(const std::string &node_id)
 {
-  auto items = scene()->items();
+  if (NodeRecord *p_record = this->get_node_record(node_id))
+    this->delete_node_record(p_record);
+}
 
-  for (QGraphicsItem *item : items)
-    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      if (p_node->get_id() == node_id)
-        this->delete_graphics_node(p_node);
+void GraphViewer::render_scene_area(QPainter     *painter,
+                                    const QRectF &target,
+                                    const QRectF &source)
+{
+  // records of the area get their graphics items
+  this->materialize_area(source);
+
+  // the background is drawn by the view, not by the scene
+  painter->fillRect(target, GN_STYLE->viewer.color_bg);
+  this->scene()->render(painter, target, source, Qt::IgnoreAspectRatio);
 }
 
 void GraphViewer::resizeEvent(QResizeEvent *event)
 {
   QGraphicsView::resizeEvent(event);
 
+  if (!this->graph_scene) // detached
+    return;
+
   for (size_t k = 0; k < this->static_items.size(); k++)
   {
     // Map the desired position in the view to the scene coordinates
@@ -1224,6 +3012,28 @@ void GraphViewer::resizeEvent(QResizeEvent *event)
                                          this->static_items_positions[k]);
     this->static_items[k]->setPos(scene_pos);
   }
+
+  this->schedule_items_update();
+  this->schedule_widgets_update();
+}
+
+void GraphViewer::reset_telemetry()
+{
+  // runs in progress are still timed
+  for (auto &[_, record] : this->graph_scene->node_records)
+  {
+    const int64_t start_time = record.telemetry.start_time;
+    record.telemetry = NodeTelemetry();
+    record.telemetry.start_time = start_time;
+  }
+
+  // critical path analysis included
+  for (auto &[p_record, _] : this->graph_scene->link_records)
+    p_record->is_critical = false;
+
+  this->update_critical_links();
+  this->graph_scene->telemetry_overlay.max_value = 0.0;
+  this->schedule_compute_repaint();
 }
 
 void GraphViewer::save_screenshot(const std::string &fname)
@@ -1232,15 +3042,131 @@ void GraphViewer::save_screenshot(const std::string &fname)
   pixMap.save(fname.c_str());
 }
 
+void GraphViewer::scrollContentsBy(int dx, int dy)
+{
+  QGraphicsView::scrollContentsBy(dx, dy);
+
+  if (!this->graph_scene) // detached
+    return;
+
+  // the dataflow legend stays in place, it must not be scrolled with the content
+  if (this->graph_scene->dataflow_overlay.is_visible)
+    this->viewport()->update();
+}
+
+void GraphViewer::schedule_compute_repaint()
+{
+  for (GraphViewer *p_viewer : this->graph_scene->get_viewers())
+    if (!p_viewer->is_compute_repaint_pending)
+    {
+      p_viewer->is_compute_repaint_pending = true;
+      p_viewer->schedule_frame();
+    }
+}
+
+void GraphViewer::schedule_frame()
+{
+  if (this->frame_timer->isActive())
+    return;
+
+  // right away if the previous frame is old enough
+  const qint64 interval = GN_STYLE->viewer.frame_interval;
+  const qint64 elapsed = this->frame_clock.isValid() ? this->frame_clock.elapsed()
+                                                     : interval;
+
+  this->frame_timer->start(int(std::clamp(interval - elapsed, qint64(0), interval)));
+}
+
+void GraphViewer::schedule_graph_changed()
+{
+  // at most one change set per event loop turn, emitted by the main
+  // viewer which lives as long as the scene
+  if (this->graph_scene->is_graph_changed_scheduled)
+    return;
+
+  GraphViewer *p_main = this->graph_scene->get_main_viewer();
+
+  this->graph_scene->is_graph_changed_scheduled = true;
+  QTimer::singleShot(0, p_main, [p_main]() { p_main->flush_changes(); });
+}
+
+void GraphViewer::schedule_items_update()
+{
+  // coalesced, at most one update per event loop turn
+  if (this->is_items_update_scheduled)
+    return;
+
+  this->is_items_update_scheduled = true;
+  QTimer::singleShot(0, this, [this]() { this->update_items(); });
+}
+
+void GraphViewer::schedule_widgets_update()
+{
+  // coalesced, at most one update per event loop turn
+  if (this->is_widgets_update_scheduled)
+    return;
+
+  this->is_widgets_update_scheduled = true;
+  QTimer::singleShot(0, this, [this]() { this->update_widgets(); });
+}
+
 void GraphViewer::select_all()
 {
-  for (QGraphicsItem *item : this->scene()->items())
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
     if (!is_item_static(item))
       item->setSelected(true);
 
+  // nodes hidden in a collapsed group excluded
+  for (auto &[_, record] : this->graph_scene->node_records)
+    record.is_selected = !record.p_summary;
+
   Q_EMIT this->selection_has_changed();
 }
 
+void GraphViewer::set_busy(bool state) { this->graph_scene->is_busy = state; }
+
+void GraphViewer::set_compute_state(std::span<const NodeHandle> handles,
+                                    ComputeState                state)
+{
+  Logger::log()->trace("GraphViewer::set_compute_state: {} node(s)", handles.size());
+
+  for (NodeHandle handle : handles)
+    if (NodeRecord *p_record = this->get_node_record(handle))
+      this->apply_compute_state(p_record, state, false);
+
+  this->schedule_compute_repaint();
+}
+
+void GraphViewer::set_compute_state(std::span<const std::string> node_ids,
+                                    ComputeState                 state)
+{
+  Logger::log()->trace("GraphViewer::set_compute_state: {} node(s)", node_ids.size());
+
+  for (const std::string &node_id : node_ids)
+    if (NodeRecord *p_record = this->get_node_record(node_id))
+      this->apply_compute_state(p_record, state, false);
+
+  this->schedule_compute_repaint();
+}
+
+void GraphViewer::set_node_metric(NodeHandle handle, TelemetryMetric metric, double value)
+{
+  NodeRecord *p_record = this->get_node_record(handle);
+
+  if (!p_record)
+    return;
+
+  p_record->telemetry.set(metric, value);
+
+  TelemetryOverlay &overlay = this->graph_scene->telemetry_overlay;
+
+  if (overlay.is_visible && overlay.metric == metric)
+  {
+    overlay.max_value = std::max(overlay.max_value, p_record->telemetry.get(metric));
+    this->schedule_compute_repaint();
+  }
+}
+
 void GraphViewer::set_enabled(bool state)
 {
   this->setEnabled(state);
@@ -1249,10 +3175,24 @@ void GraphViewer::set_enabled(bool state)
 
 void GraphViewer::set_node_as_selected(const std::string &node_id)
 {
-  GraphicsNode *p_node = this->get_graphics_node_by_id(node_id);
+  NodeRecord *p_record = this->get_node_record(node_id);
+
+  if (p_record && p_record->p_node)
+    p_record->p_node->setSelected(true);
+  else if (p_record)
+    p_record->is_selected = true;
+
+  Q_EMIT this->selection_has_changed();
+}
+
+void GraphViewer::set_node_as_selected(NodeHandle handle)
+{
+  NodeRecord *p_record = this->get_node_record(handle);
 
-  if (p_node)
-    p_node->setSelected(true);
+  if (p_record && p_record->p_node)
+    p_record->p_node->setSelected(true);
+  else if (p_record)
+    p_record->is_selected = true;
 
   Q_EMIT this->selection_has_changed();
 }
@@ -1260,37 +3200,525 @@ void GraphViewer::set_node_as_selected(const std::string &node_id)
 void GraphViewer::set_node_inventory(
     const std::map<std::string, std::string> &new_node_inventory)
 {
-  this->node_inventory = new_node_inventory;
+  this->graph_scene->node_inventory = new_node_inventory;
+}
+
+void GraphViewer::set_stats_interval(int interval)
+{
+  if (interval > 0)
+    this->stats_timer->start(interval);
+  else
+    this->stats_timer->stop();
+}
+
+void GraphViewer::set_critical_path_visible(bool state)
+{
+  this->graph_scene->telemetry_overlay.is_critical_path_visible = state;
+
+  if (state)
+    this->compute_critical_path();
+
+  this->update_critical_links();
+  this->schedule_compute_repaint();
+}
+
+void GraphViewer::set_dataflow_overlay(bool       state,
+                                       LinkMetric width_metric,
+                                       LinkMetric color_metric)
+{
+  DataflowOverlay &overlay = this->graph_scene->dataflow_overlay;
+
+  overlay.is_visible = state;
+  overlay.width_metric = width_metric;
+  overlay.color_metric = color_metric;
+  overlay.max_width_value = 0.0;
+  overlay.max_color_value = 0.0;
+
+  for (auto &[p_record, _] : this->graph_scene->link_records)
+  {
+    overlay.max_width_value = std::max(overlay.max_width_value,
+                                       p_record->telemetry.get(width_metric));
+    overlay.max_color_value = std::max(overlay.max_color_value,
+                                       p_record->telemetry.get(color_metric));
+  }
+
+  this->schedule_compute_repaint();
+}
+
+bool GraphViewer::set_link_metric(NodeHandle node_out,
+                                  int        port_out,
+                                  NodeHandle node_in,
+                                  int        port_in,
+                                  LinkMetric metric,
+                                  double     value)
+{
+  LinkRecord *p_record = this->get_link_record(node_out, port_out, node_in, port_in);
+
+  if (!p_record)
+    return false;
+
+  this->apply_link_metric(p_record, metric, value);
+  return true;
+}
+
+bool GraphViewer::set_port_metric(NodeHandle node_out,
+                                  int        port_out,
+                                  LinkMetric metric,
+                                  double     value)
+{
+  NodeRecord *p_node_out = this->get_node_record(node_out);
+  bool        has_link = false;
+
+  if (!p_node_out)
+    return false;
+
+  for (LinkRecord *p_record : p_node_out->links)
+    if (p_record->node_out == p_node_out && p_record->port_out == port_out)
+    {
+      this->apply_link_metric(p_record, metric, value);
+      has_link = true;
+    }
+
+  return has_link;
+}
+
+void GraphViewer::set_telemetry_overlay(bool state, TelemetryMetric metric)
+{
+  TelemetryOverlay &overlay = this->graph_scene->telemetry_overlay;
+
+  overlay.is_visible = state;
+  overlay.metric = metric;
+  overlay.max_value = 0.0;
+
+  for (auto &[_, record] : this->graph_scene->node_records)
+    overlay.max_value = std::max(overlay.max_value, record.telemetry.get(metric));
+
+  this->schedule_compute_repaint();
+}
+
+void GraphViewer::set_thumbnail_converter(const std::string &data_type,
+                                          ThumbnailConverter converter)
+{
+  this->graph_scene->thumbnail_cache->set_converter(data_type, converter);
+
+  // nodes already there may now have a thumbnail
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
+    if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
+      p_node->set_thumbnail_cache(this->graph_scene->thumbnail_cache);
+}
+
+void GraphViewer::setup_node_callbacks()
+{
+  // shared by all the nodes of the scene, whichever view created them
+  GraphicsNodeCallbacks &callbacks = this->graph_scene->node_callbacks;
+
+  callbacks.right_clicked = [this](const std::string &node_id, QPointF scene_pos)
+  { this->on_node_right_clicked(node_id, scene_pos); };
+
+  callbacks.connection_started = [this](GraphicsNode *from, int port_index)
+  { this->on_connection_started(from, port_index); };
+
+  callbacks.connection_finished = [this](GraphicsNode *from,
+                                         int           port_from_index,
+                                         GraphicsNode *to,
+                                         int           port_to_index)
+  { this->on_connection_finished(from, port_from_index, to, port_to_index); };
+
+  callbacks.connection_dropped = [this](GraphicsNode *from, int port_index, QPointF pos)
+  { this->on_connection_dropped(from, port_index, pos); };
+
+  callbacks.selected = [this](const std::string &node_id)
+  {
+    Q_EMIT this->node_selected(node_id);
+    Q_EMIT this->node_selected_by_handle(this->get_node_handle(node_id));
+    Q_EMIT this->selection_has_changed();
+  };
+
+  callbacks.deselected = [this](const std::string &node_id)
+  {
+    Q_EMIT this->node_deselected(node_id);
+    Q_EMIT this->node_deselected_by_handle(this->get_node_handle(node_id));
+    Q_EMIT this->selection_has_changed();
+  };
+
+  callbacks.widget_activated = [this](GraphicsNode *p_node)
+  { this->touch_live_widget(p_node); };
+}
+
+void GraphViewer::setup_view()
+{
+  this->setRenderHint(QPainter::Antialiasing);
+  this->setRenderHint(QPainter::SmoothPixmapTransform);
+  this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  this->setDragMode(QGraphicsView::NoDrag);
+  this->setFocusPolicy(Qt::StrongFocus);
+
+  this->setBackgroundBrush(QBrush(GN_STYLE->viewer.color_bg));
+
+  // restore full rendering quality once navigation is idle
+  this->navigation_timer = new QTimer(this);
+  this->navigation_timer->setSingleShot(true);
+  this->connect(this->navigation_timer,
+                &QTimer::timeout,
+                this,
+                &GraphViewer::stop_navigation);
+
+  // accumulated input is applied once per frame
+  this->frame_timer = new QTimer(this);
+  this->frame_timer->setSingleShot(true);
+  this->frame_timer->setTimerType(Qt::PreciseTimer);
+  this->connect(this->frame_timer, &QTimer::timeout, this, &GraphViewer::process_frame);
+
+  // periodic statistics, off by default
+  this->stats_timer = new QTimer(this);
+  this->connect(this->stats_timer,
+                &QTimer::timeout,
+                this,
+                [this]() { Q_EMIT this->stats_updated(this->get_stats()); });
+
+  if (GN_STYLE->viewer.add_toolbar)
+    this->add_toolbar(GN_STYLE->viewer.toolbar_window_pos);
+}
+
+void GraphViewer::start_navigation()
+{
+  if (!this->is_navigating && GN_STYLE->viewer.draft_during_navigation)
+  {
+    this->is_navigating = true;
+    this->setRenderHint(QPainter::Antialiasing, false);
+    this->setRenderHint(QPainter::TextAntialiasing, false);
+    this->setRenderHint(QPainter::SmoothPixmapTransform, false);
+  }
+
+  this->navigation_timer->start(GN_STYLE->viewer.draft_idle_timeout);
+}
+
+void GraphViewer::stop_navigation()
+{
+  if (this->is_navigating)
+  {
+    this->is_navigating = false;
+    this->setRenderHint(QPainter::Antialiasing, true);
+    this->setRenderHint(QPainter::TextAntialiasing, true);
+    this->setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    // one final full quality repaint
+    this->viewport()->update();
+  }
+
+  // the visible area is settled, time to (de)activate node widgets
+  this->schedule_items_update();
+  this->schedule_widgets_update();
+}
+
+void GraphViewer::sync_node_record(NodeRecord *p_record)
+{
+  GraphicsNode *p_node = p_record->p_node;
+  const QRectF  previous_rect = p_record->rect();
+
+  p_record->pos = p_node->pos();
+  p_record->size = p_node->rect().size();
+  p_record->is_selected = p_node->isSelected();
+  p_record->is_pinned = p_node->get_is_node_pinned();
+  p_record->compute_state = p_node->get_compute_state();
+  p_record->is_widget_visible = p_node->get_is_widget_visible();
+  p_record->data_version = p_node->get_data_version();
+  p_record->widget_factory = p_node->get_widget_factory();
+  p_record->widget_size = p_node->get_widget_size();
+
+  // moved or resized, the spatial indexes follow
+  if (p_record->rect() != previous_rect)
+  {
+    this->graph_scene->node_grid.move(p_record, p_record->rect());
+
+    for (LinkRecord *p_link_record : p_record->links)
+      this->graph_scene->link_grid.move(p_link_record, p_link_record->rect());
+  }
 }
 
 void GraphViewer::toggle_link_type()
 {
-  for (QGraphicsItem *item : this->scene()->items())
-    if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
-      this->current_link_type = p_link->toggle_link_type();
+  LinkType &link_type = this->graph_scene->current_link_type;
+  link_type = get_next_link_type(link_type);
+
+  std::vector<GraphicsLink *> links;
+  links.reserve(this->graph_scene->materialized_links.size());
+
+  for (LinkRecord *p_record : this->graph_scene->materialized_links)
+  {
+    p_record->p_link->set_link_type(link_type);
+    links.push_back(p_record->p_link);
+  }
+
+  this->update_link_paths(links);
+}
+
+void GraphViewer::touch_live_widget(GraphicsNode *p_node)
+{
+  this->graph_scene->live_widget_nodes.remove(p_node);
+  this->graph_scene->live_widget_nodes.push_front(p_node);
 }
 
 void GraphViewer::unpin_nodes()
 {
-  for (QGraphicsItem *item : this->scene()->items())
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
     if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
       p_node->set_is_node_pinned(false);
+
+  for (auto &[_, record] : this->graph_scene->node_records)
+    record.is_pinned = false;
+}
+
+void GraphViewer::update_items(bool force)
+{
+  this->is_items_update_scheduled = false;
+
+  // everything gets an item (also catches up if virtualization has just
+  // been turned off)
+  if (!GN_STYLE->viewer.virtualize_items)
+  {
+    const GraphScene *p_scene = this->graph_scene;
+    LinkPathBatch     link_path_batch(this);
+
+    if (p_scene->materialized_links.size() < p_scene->link_records.size())
+      for (auto &[p_record, _] : this->graph_scene->link_records)
+        this->materialize_link(p_record);
+
+    if (p_scene->materialized_nodes.size() < p_scene->node_records.size())
+      for (auto &[_, record] : this->graph_scene->node_records)
+        if (!record.p_summary)
+          this->materialize_node(&record);
+
+    this->is_lod_active = false;
+    return;
+  }
+
+  const QRectF visible_rect = this->mapToScene(this->viewport()->rect()).boundingRect();
+  const bool   is_lod = this->transform().m11() <
+                      GN_STYLE->viewer.virtualization_lod_zoom;
+
+  // nothing to do as long as the viewport remains within the area
+  // already covered
+  if (!force && is_lod == this->is_lod_active && this->active_rect.contains(visible_rect))
+    return;
+
+  if (is_lod != this->is_lod_active)
+    this->viewport()->update();
+
+  const float mx = GN_STYLE->viewer.virtualization_margin * visible_rect.width();
+  const float my = GN_STYLE->viewer.virtualization_margin * visible_rect.height();
+
+  this->active_rect = is_lod ? QRectF() : visible_rect.adjusted(-mx, -my, mx, my);
+  this->is_lod_active = is_lod;
+
+  // release items out of the active area of every view. Items the user is
+  // interacting with (dragged nodes, connection being built) are left
+  // alone, as well as nodes holding a widget that cannot be rebuilt
+  if (!this->scene()->mouseGrabberItem() && !this->graph_scene->temp_link)
+  {
+    std::vector<NodeRecord *> nodes_to_release;
+    std::vector<LinkRecord *> links_to_release;
+
+    for (NodeRecord *p_record : this->graph_scene->materialized_nodes)
+    {
+      this->sync_node_record(p_record);
+
+      const bool has_fixed_widget = p_record->p_node->has_widget() &&
+                                    !p_record->widget_factory;
+
+      const bool is_out = p_record->p_summary ||
+                          !this->is_in_active_area(p_record->rect());
+
+      if (!has_fixed_widget && is_out)
+        nodes_to_release.push_back(p_record);
+    }
+
+    for (LinkRecord *p_record : this->graph_scene->materialized_links)
+      if (!this->is_in_active_area(p_record->rect()))
+        links_to_release.push_back(p_record);
+
+    for (LinkRecord *p_record : links_to_release)
+      this->release_link(p_record);
+
+    for (NodeRecord *p_record : nodes_to_release)
+      this->release_node(p_record);
+  }
+
+  // and create the ones entering it
+  if (!is_lod)
+    this->materialize_area(this->active_rect);
+}
+
+void GraphViewer::update_critical_links()
+{
+  const bool is_visible = this->graph_scene->telemetry_overlay.is_critical_path_visible;
+
+  for (LinkRecord *p_record : this->graph_scene->materialized_links)
+    if (p_record->p_link)
+      p_record->p_link->set_is_critical(is_visible && p_record->is_critical);
+}
+
+void GraphViewer::update_link_paths(const std::vector<GraphicsLink *> &links)
+{
+  // the items are only read here, the workers get plain values
+  struct PathInput
+  {
+    QPointF  start_point;
+    QPointF  end_point;
+    LinkType link_type;
+  };
+
+  std::vector<GraphicsLink *> established;
+  std::vector<PathInput>      inputs;
+  established.reserve(links.size());
+  inputs.reserve(links.size());
+
+  for (GraphicsLink *p_link : links)
+  {
+    PathInput input;
+
+    if (p_link->get_endpoints(input.start_point, input.end_point))
+    {
+      input.link_type = p_link->get_link_type();
+      established.push_back(p_link);
+      inputs.push_back(input);
+    }
+    else
+    {
+      p_link->update_path();
+    }
+  }
+
+  std::vector<QPainterPath> paths(inputs.size());
+
+  GN_SCHEDULER->parallel_for(
+      0,
+      inputs.size(),
+      [&inputs, &paths](size_t k_begin, size_t k_end)
+      {
+        for (size_t k = k_begin; k < k_end; k++)
+          paths[k] = build_link_path(inputs[k].start_point,
+                                     inputs[k].end_point,
+                                     inputs[k].link_type);
+      },
+      64);
+
+  // scene index and repaints, on this thread only
+  for (size_t k = 0; k < established.size(); k++)
+    established[k]->set_link_path(paths[k]);
+
+  Logger::log()->trace("GraphViewer::update_link_paths: {} paths", paths.size());
+}
+
+void GraphViewer::update_telemetry(NodeRecord  *p_record,
+                                   ComputeState state,
+                                   int64_t      time)
+{
+  NodeTelemetry &telemetry = p_record->telemetry;
+
+  if (state == ComputeState::RUNNING)
+  {
+    telemetry.start_time = time;
+    return;
+  }
+
+  // any other state ends the run, queued excepted (not started yet)
+  if (telemetry.start_time < 0 || state == ComputeState::QUEUED)
+    return;
+
+  telemetry.duration = 1e-6 * double(time - telemetry.start_time);
+  telemetry.end_time = time;
+  telemetry.total_duration += telemetry.duration;
+  telemetry.compute_count++;
+  telemetry.start_time = -1;
+
+  TelemetryOverlay &overlay = this->graph_scene->telemetry_overlay;
+
+  if (overlay.is_visible)
+  {
+    overlay.max_value = std::max(overlay.max_value, telemetry.get(overlay.metric));
+    this->schedule_compute_repaint();
+  }
+}
+
+void GraphViewer::update_widgets()
+{
+  this->is_widgets_update_scheduled = false;
+
+  if (!GN_STYLE->viewer.virtualize_widgets)
+    return;
+
+  // visible areas of all the views sharing the scene, zoomed out views
+  // excluded
+  std::vector<QRectF> visible_rects = {};
+
+  for (GraphViewer *p_viewer : this->graph_scene->get_viewers())
+    if (p_viewer->transform().m11() >= GN_STYLE->viewer.widget_min_zoom)
+      visible_rects.push_back(
+          p_viewer->mapToScene(p_viewer->viewport()->rect()).boundingRect());
+
+  auto is_visible = [&visible_rects](const QRectF &rect)
+  {
+    for (const QRectF &visible_rect : visible_rects)
+      if (visible_rect.intersects(rect))
+        return true;
+    return false;
+  };
+
+  // live widgets that left the viewports are swapped for their snapshot
+  std::list<GraphicsNode *> &live_nodes = this->graph_scene->live_widget_nodes;
+
+  for (auto it = live_nodes.begin(); it != live_nodes.end();)
+  {
+    GraphicsNode *p_node = *it;
+
+    if (!is_visible(p_node->sceneBoundingRect()))
+    {
+      p_node->set_widget_live(false);
+      it = live_nodes.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  // visible ones are made live (and created on first sight if they
+  // come from a factory), this moves them to the front of the list
+  for (const QRectF &visible_rect : visible_rects)
+    for (QGraphicsItem *item : this->scene()->items(visible_rect))
+      if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
+        if (p_node->has_widget() && p_node->isVisible())
+        {
+          if (p_node->is_widget_live())
+            this->touch_live_widget(p_node);
+          else
+            p_node->set_widget_live(true);
+        }
+
+  // eventually enforce the live widgets budget
+  while ((int)live_nodes.size() > GN_STYLE->viewer.max_live_widgets)
+  {
+    live_nodes.back()->set_widget_live(false);
+    live_nodes.pop_back();
+  }
 }
 
 void GraphViewer::wheelEvent(QWheelEvent *event)
 {
+  // a wheel notch (120) zooms by 'factor', high-resolution devices send
+  // fractions of it
   const float factor = 1.2f;
-  QPointF     mouse_scene_pos = this->mapToScene(event->position().toPoint());
+  const float zoom_log = std::log(factor) * event->angleDelta().y() / 120.f;
 
-  if (event->angleDelta().y() > 0)
-    this->scale(factor, factor);
+  if (GN_STYLE->viewer.coalesce_input)
+  {
+    this->start_navigation();
+    this->pending_zoom_log += zoom_log;
+    this->zoom_anchor_pos = event->position().toPoint();
+    this->schedule_frame();
+  }
   else
-    this->scale(1.f / factor, 1.f / factor);
-
-  // adjust the view to maintain the zoom centered on the mouse position
-  QPointF new_mouse_scene_pos = this->mapToScene(event->position().toPoint());
-  QPointF delta = new_mouse_scene_pos - mouse_scene_pos;
-  this->translate(delta.x(), delta.y());
+    this->apply_zoom(std::exp(zoom_log), event->position().toPoint());
 
   event->accept();
 }
@@ -1305,6 +3733,35 @@ void GraphViewer::zoom_to_content()
   bbox.adjust(-margin_x, -margin_y, margin_x, margin_y);
 
   this->fitInView(bbox, Qt::KeepAspectRatio);
+  this->schedule_items_update();
+  this->schedule_widgets_update();
+}
+
+// --- MemoryReport
+
+nlohmann::json MemoryReport::json_to() const
+{
+  nlohmann::json json;
+
+  json["graphics_nodes"] = this->graphics_nodes;
+  json["graphics_links"] = this->graphics_links;
+  json["node_geometries"] = this->node_geometries;
+  json["node_records"] = this->node_records;
+  json["link_records"] = this->link_records;
+  json["spatial_indexes"] = this->spatial_indexes;
+  json["thumbnails"] = this->thumbnails;
+  json["graphics_nodes_count"] = this->graphics_nodes_count;
+  json["graphics_links_count"] = this->graphics_links_count;
+  json["total"] = this->total();
+
+  return json;
+}
+
+size_t MemoryReport::total() const
+{
+  return this->graphics_nodes + this->graphics_links + this->node_geometries +
+         this->node_records + this->link_records + this->spatial_indexes +
+         this->thumbnails;
 }
 
 } // namespace gngui
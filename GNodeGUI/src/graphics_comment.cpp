@@ -9,7 +9,9 @@
 
 #include "gnodegui/graphics_comment.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
 #include "gnodegui/style.hpp"
+#include "gnodegui/utils.hpp"
 
 namespace gngui
 {
@@ -75,6 +77,8 @@ void GraphicsComment::paint(QPainter                       *painter,
                             const QStyleOptionGraphicsItem *option,
                             QWidget                        *widget)
 {
+  GN_COUNTERS->comment_paints++;
+
   Q_UNUSED(option);
   Q_UNUSED(widget);
 
@@ -90,7 +94,13 @@ void GraphicsComment::paint(QPainter                       *painter,
                            GN_STYLE->comment.rounding_radius,
                            GN_STYLE->comment.rounding_radius);
 
-  // comment text
+  // comment text, skipped for draft rendering
+  if (is_draft_render(widget))
+  {
+    painter->restore();
+    return;
+  }
+
   painter->setPen(QPen(GN_STYLE->comment.color_text));
 
   QRectF text_rect = this->rect();
@@ -14,7 +14,9 @@
 #include "gnodegui/graphics_group.hpp"
 #include "gnodegui/graphics_link.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
 #include "gnodegui/style.hpp"
+#include "gnodegui/utils.hpp"
 
 namespace gngui
 {
@@ -55,9 +57,10 @@ void GraphicsGroup::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
 {
   // first check that there is no node underneath, if so, nothing is
   // done and priority is given to the node context menu
-  for (auto &item : this->scene()->items())
+  for (auto &item : get_scene_items(this->scene()))
     if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
-      if (p_node->contains(p_node->mapFromScene(event->scenePos())))
+      if (p_node->isVisible() &&
+          p_node->contains(p_node->mapFromScene(event->scenePos())))
         return;
 
   // if not, generate the context menu
@@ -67,6 +70,15 @@ void GraphicsGroup::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
   int   icon_size = menu.style()->pixelMetric(QStyle::PM_SmallIconSize);
   QSize psize = QSize(icon_size, icon_size);
 
+  // collapse / expand action, only when someone is there to handle it
+  QAction *collapse_action = nullptr;
+
+  if (this->collapse_toggled)
+  {
+    collapse_action = menu.addAction(this->is_collapsed ? "Expand" : "Collapse");
+    menu.addSeparator();
+  }
+
   // create actions with colored rectangles
   std::vector<QAction *> actions = {};
 
@@ -80,6 +92,13 @@ void GraphicsGroup::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
   // show the menu at the event's position
   QAction *selected_action = menu.exec(event->screenPos());
 
+  if (selected_action && selected_action == collapse_action)
+  {
+    this->collapse_toggled(this);
+    event->accept();
+    return;
+  }
+
   // set the color based on the selected action
   auto it = std::find(actions.begin(), actions.end(), selected_action);
   if (it != actions.end())
@@ -92,6 +111,11 @@ void GraphicsGroup::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
   event->accept();
 }
 
+std::string GraphicsGroup::get_caption() const
+{
+  return this->caption_item->toPlainText().toStdString();
+}
+
 GraphicsGroup::Corner GraphicsGroup::get_resize_corner(const QPointF &pos) const
 {
   QRectF rect = this->rect();
@@ -216,6 +240,7 @@ nlohmann::json GraphicsGroup::json_to() const
   json["position"] = {box.x(), box.y()};
   json["width"] = box.width();
   json["height"] = box.height();
+  json["is_collapsed"] = this->is_collapsed;
 
   return json;
 }
@@ -325,7 +350,7 @@ void GraphicsGroup::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     }
 
     // then make the links follow (all of them)
-    for (QGraphicsItem *item : this->scene()->items())
+    for (QGraphicsItem *item : get_scene_items(this->scene()))
     {
       if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
         p_link->update_path();
@@ -353,6 +378,8 @@ void GraphicsGroup::paint(QPainter                       *painter,
                           const QStyleOptionGraphicsItem *option,
                           QWidget                        *widget)
 {
+  GN_COUNTERS->group_paints++;
+
   Q_UNUSED(option);
   Q_UNUSED(widget);
 
@@ -368,7 +395,9 @@ void GraphicsGroup::paint(QPainter                       *painter,
   {
     pen_width = GN_STYLE->group.pen_width_hovered;
   }
-  painter->setPen(QPen(this->color, pen_width));
+  // dashed border when the content is collapsed
+  painter->setPen(
+      QPen(this->color, pen_width, this->is_collapsed ? Qt::DashLine : Qt::SolidLine));
 
   // set the fill color with the defined transparency
   QColor fill_color = this->color;
@@ -391,7 +420,7 @@ void GraphicsGroup::rearrange_z_order_by_size()
   // reorder Z-order of groups by group size (smaller groups in front)
   std::vector<GraphicsGroup *> groups;
 
-  for (QGraphicsItem *item : this->scene()->items())
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
   {
     if (GraphicsGroup *p_group = dynamic_cast<GraphicsGroup *>(item))
       groups.push_back(p_group);
@@ -432,6 +461,12 @@ void GraphicsGroup::set_color(const QColor &new_color)
   this->update();
 }
 
+void GraphicsGroup::set_is_collapsed(bool new_state)
+{
+  this->is_collapsed = new_state;
+  this->update();
+}
+
 void GraphicsGroup::update_caption_position()
 {
   QRectF  rect = this->rect();
@@ -451,7 +486,8 @@ void GraphicsGroup::update_selected_items()
   this->selected_items.clear();
   for (QGraphicsItem *item : this->scene()->items(bbox))
   {
-    if (item == this)
+    // hidden items (nodes of a collapsed group) stay where they are
+    if (item == this || !item->isVisible())
       continue;
 
     if (bbox.contains(item->sceneBoundingRect()))
@@ -1,13 +1,17 @@
 /* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
+#include <algorithm>
+
 #include <QGraphicsScene>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
 
+#include "gnodegui/graph_scene.hpp"
 #include "gnodegui/graphics_link.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
 #include "gnodegui/style.hpp"
 #include "gnodegui/utils.hpp"
 
@@ -15,7 +19,7 @@ namespace gngui
 {
 
 GraphicsLink::GraphicsLink(QColor color, LinkType link_type, QGraphicsItem *parent)
-    : QGraphicsPathItem(parent), color(color), link_type(link_type)
+    : QGraphicsPathItem(parent)
 {
   // item flags
 
@@ -23,36 +27,53 @@ GraphicsLink::GraphicsLink(QColor color, LinkType link_type, QGraphicsItem *pare
   this->setFlag(QGraphicsItem::ItemIsMovable, false);
   this->setAcceptHoverEvents(true);
 
-  if (this->color == QColor(0, 0, 0, 0))
-    this->color = GN_STYLE->link.color_default;
-
-  this->setPen(QPen(this->color, GN_STYLE->link.pen_width));
-  this->setZValue(-1);
+  this->reset(color, link_type);
 }
 
-GraphicsLink::~GraphicsLink()
-{
-  if (is_valid(this->node_out))
-    this->node_out->set_is_port_connected(this->port_out_index, nullptr);
-  if (is_valid(this->node_in))
-    this->node_in->set_is_port_connected(this->port_in_index, nullptr);
-}
+GraphicsLink::~GraphicsLink() { this->release_ports(); }
 
 QRectF GraphicsLink::boundingRect() const
 {
+  // wide enough for the dataflow overlay strokes
+  const float margin = std::max(GN_STYLE->link.port_tip_radius,
+                                0.5f * GN_STYLE->link.pen_width_dataflow_max);
+
   QRectF bbox = this->path().boundingRect();
-  bbox.adjust(-GN_STYLE->link.port_tip_radius,
-              -GN_STYLE->link.port_tip_radius,
-              GN_STYLE->link.port_tip_radius,
-              GN_STYLE->link.port_tip_radius);
+  bbox.adjust(-margin, -margin, margin, margin);
   return bbox;
 }
 
+bool GraphicsLink::get_endpoints(QPointF &start_point, QPointF &end_point) const
+{
+  if (!is_valid(this->node_out) || !is_valid(this->node_in))
+    return false;
+
+  // guards
+  if (port_out_index >= (int)this->node_out->get_geometry().port_rects.size())
+    return false;
+  if (port_in_index >= (int)this->node_in->get_geometry().port_rects.size())
+    return false;
+
+  start_point = this->node_out->scenePos() +
+                this->node_out->get_geometry().port_rects[port_out_index].center();
+  end_point = this->node_in->scenePos() +
+              this->node_in->get_geometry().port_rects[port_in_index].center();
+
+  return true;
+}
+
+size_t GraphicsLink::get_memory_usage() const
+{
+  return sizeof(GraphicsLink) +
+         this->path().elementCount() * sizeof(QPainterPath::Element) +
+         this->draft_polyline.capacity() * sizeof(QPointF);
+}
+
 void GraphicsLink::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
   this->is_link_hovered = true;
   this->setCursor(Qt::PointingHandCursor);
-  this->update();
+  this->update_stroke();
 
   QGraphicsPathItem::hoverEnterEvent(event);
 }
@@ -61,7 +82,7 @@ void GraphicsLink::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
   this->is_link_hovered = false;
   this->setCursor(Qt::ArrowCursor);
-  this->update();
+  this->update_stroke();
 
   QGraphicsPathItem::hoverLeaveEvent(event);
 }
@@ -91,6 +112,8 @@ void GraphicsLink::paint(QPainter                       *painter,
                          const QStyleOptionGraphicsItem *option,
                          QWidget                        *widget)
 {
+  GN_COUNTERS->link_paints++;
+
   Q_UNUSED(option);
   Q_UNUSED(widget);
 
@@ -102,9 +125,44 @@ void GraphicsLink::paint(QPainter                       *painter,
                       : (this->isSelected() ? GN_STYLE->link.pen_width_selected
                                             : GN_STYLE->link.pen_width);
 
+  // dataflow overlay in place of the data type color
+  const GraphScene *p_scene = dynamic_cast<const GraphScene *>(this->scene());
+
+  if (p_scene && this->p_telemetry && p_scene->get_dataflow_overlay().is_visible &&
+      !this->isSelected())
+  {
+    const DataflowOverlay &overlay = p_scene->get_dataflow_overlay();
+
+    pcolor = overlay.get_color(this->p_telemetry->get(overlay.color_metric));
+    pwidth = std::max(pwidth,
+                      overlay.get_width(this->p_telemetry->get(overlay.width_metric)));
+  }
+
+  if (this->is_critical && !this->isSelected())
+  {
+    pcolor = GN_STYLE->link.color_critical;
+    pwidth = std::max(pwidth, GN_STYLE->link.pen_width_critical);
+  }
+
+  // draft rendering while navigating: coarse polyline, solid pen and no tips
+  if (is_draft_render(widget))
+  {
+    if (this->draft_polyline.isEmpty() && this->path().elementCount() > 0)
+    {
+      const int npoints = 8;
+      for (int k = 0; k <= npoints; k++)
+        this->draft_polyline << this->path().pointAtPercent(float(k) / npoints);
+    }
+
+    painter->setPen(QPen(pcolor, pwidth));
+    painter->drawPolyline(this->draft_polyline);
+    painter->restore();
+    return;
+  }
+
   // link
   QPen pen(pcolor);
-  pen.setWidth(pwidth);
+  pen.setWidthF(pwidth);
   pen.setStyle(this->pen_style);
   painter->setPen(pen);
   painter->setBrush(Qt::NoBrush);
@@ -130,6 +188,42 @@ void GraphicsLink::paint(QPainter                       *painter,
   painter->restore();
 }
 
+void GraphicsLink::release_ports()
+{
+  if (is_valid(this->node_out))
+    this->node_out->set_is_port_connected(this->port_out_index, nullptr);
+  if (is_valid(this->node_in))
+    this->node_in->set_is_port_connected(this->port_in_index, nullptr);
+}
+
+void GraphicsLink::reset(QColor new_color, LinkType new_link_type)
+{
+  this->release_ports();
+
+  this->node_out = nullptr;
+  this->node_in = nullptr;
+  this->port_out_index = -1;
+  this->port_in_index = -1;
+
+  this->color = new_color;
+  if (this->color == QColor(0, 0, 0, 0))
+    this->color = GN_STYLE->link.color_default;
+
+  this->link_type = new_link_type;
+  this->pen_style = Qt::DashLine;
+  this->is_link_hovered = false;
+  this->is_critical = false;
+  this->p_telemetry = nullptr;
+  this->draft_polyline.clear();
+
+  this->setSelected(false);
+  this->setVisible(true);
+  this->setPath(QPainterPath());
+  this->setPen(QPen(this->color, GN_STYLE->link.pen_width));
+  this->setZValue(-1);
+  this->unsetCursor();
+}
+
 void GraphicsLink::set_endnodes(GraphicsNode *from,
                                 int           port_from_index,
                                 GraphicsNode *to,
@@ -161,31 +255,141 @@ void GraphicsLink::set_endnodes(GraphicsNode *from,
 }
 
 void GraphicsLink::set_endpoints(const QPointF &start_point, const QPointF &end_point)
+{
+  this->set_link_path(build_link_path(start_point, end_point, this->link_type));
+}
+
+void GraphicsLink::set_is_critical(bool new_state)
+{
+  if (this->is_critical == new_state)
+    return;
+
+  this->is_critical = new_state;
+  this->update_stroke();
+}
+
+void GraphicsLink::set_link_path(const QPainterPath &new_path)
+{
+  GN_COUNTERS->link_path_rebuilds++;
+
+  this->setPath(new_path);
+  this->draft_polyline.clear();
+}
+
+void GraphicsLink::set_link_type(const LinkType &new_link_type)
+{
+  this->link_type = new_link_type;
+  this->update();
+}
+
+void GraphicsLink::set_pen_style(const Qt::PenStyle &new_pen_style)
+{
+  this->pen_style = new_pen_style;
+}
+
+void GraphicsLink::set_telemetry(const LinkTelemetry *new_p_telemetry)
+{
+  this->p_telemetry = new_p_telemetry;
+}
+
+QPainterPath GraphicsLink::shape() const
+{
+  QPainterPathStroker stroker;
+  stroker.setWidth(40);
+  QPainterPath widened_path = stroker.createStroke(path());
+  return widened_path.united(path());
+}
+
+LinkType GraphicsLink::toggle_link_type()
+{
+  this->set_link_type(get_next_link_type(this->link_type));
+  this->update_path();
+
+  return this->link_type;
+}
+
+void GraphicsLink::update_path()
+{
+  // update path (only establisged ones, not the temporary one)
+  QPointF start_point, end_point;
+
+  if (this->get_endpoints(start_point, end_point))
+    this->set_endpoints(start_point, end_point);
+  else if (is_valid(this->node_out) && is_valid(this->node_in))
+    return; // ports out of range
+
+  this->update();
+}
+
+void GraphicsLink::update_stroke()
+{
+  const QPainterPath &path = this->path();
+
+  if (path.isEmpty())
+    return;
+
+  // the path is split in chunks of roughly constant length, each
+  // chunk invalidating its own (small) bounding rect. For long curved
+  // links this is a fraction of the full bounding rect
+  const float sample_length = 16.f;
+  const int   samples_per_chunk = 4;
+  const int   nsamples = std::clamp(int(path.length() / sample_length), 1, 128);
+
+  // half-width of the widest stroke, port tips included, plus the
+  // largest distance between the path and its sampled polyline
+  const float w = 0.5f * std::max({GN_STYLE->link.pen_width_hovered,
+                                   GN_STYLE->link.pen_width_selected,
+                                   GN_STYLE->link.pen_width_critical,
+                                   GN_STYLE->link.pen_width_dataflow_max}) +
+                  GN_STYLE->link.port_tip_radius + 0.5f * sample_length + 1.f;
+
+  QPointF p0 = path.pointAtPercent(0.f);
+  QRectF  chunk_rect(p0, p0);
+
+  for (int k = 1; k <= nsamples; k++)
+  {
+    QPointF p1 = path.pointAtPercent(float(k) / nsamples);
+    chunk_rect |= QRectF(p0, p1).normalized();
+    p0 = p1;
+
+    if (k % samples_per_chunk == 0 || k == nsamples)
+    {
+      this->update(chunk_rect.adjusted(-w, -w, w, w));
+      chunk_rect = QRectF(p0, p0);
+    }
+  }
+}
+
+// --- helper
+
+QPainterPath build_link_path(const QPointF &start_point,
+                             const QPointF &end_point,
+                             LinkType       link_type)
 {
   QPainterPath new_path(start_point);
 
-  if (this->link_type == LinkType::BROKEN_LINE)
+  if (link_type == LinkType::BROKEN_LINE)
   {
     float dx = std::copysign(20.f, end_point.x() - start_point.x());
     new_path.lineTo(QPointF(start_point.x() + dx, start_point.y()));
     new_path.lineTo(QPointF(end_point.x() - dx, end_point.y()));
     new_path.lineTo(end_point);
   }
-  else if (this->link_type == LinkType::CIRCUIT)
+  else if (link_type == LinkType::CIRCUIT)
   {
     QPointF mid_point = 0.5f * (start_point + end_point);
     new_path.lineTo(QPointF(mid_point.x(), start_point.y()));
     new_path.lineTo(QPointF(mid_point.x(), end_point.y()));
     new_path.lineTo(end_point);
   }
-  else if (this->link_type == LinkType::CUBIC)
+  else if (link_type == LinkType::CUBIC)
   {
     float   dx = std::abs(end_point.x() - start_point.x()) * GN_STYLE->link.curvature;
     QPointF control_point1(start_point.x() + dx, start_point.y());
     QPointF control_point2(end_point.x() - dx, end_point.y());
     new_path.cubicTo(control_point1, control_point2, end_point);
   }
-  else if (this->link_type == LinkType::DEPORTED)
+  else if (link_type == LinkType::DEPORTED)
   {
     QPointF mid_point = QPointF(0.5f * (start_point.x() + end_point.x()),
                                 start_point.y());
@@ -196,17 +400,17 @@ void GraphicsLink::set_endpoints(const QPointF &start_point, const QPointF &end_
     QPointF control_point2(end_point.x() - dx, end_point.y());
     new_path.cubicTo(control_point1, control_point2, end_point);
   }
-  else if (this->link_type == LinkType::LINEAR)
+  else if (link_type == LinkType::LINEAR)
   {
     new_path.lineTo(end_point);
   }
-  else if (this->link_type == LinkType::QUADRATIC)
+  else if (link_type == LinkType::QUADRATIC)
   {
     QPointF control_point((start_point.x() + end_point.x()) * 0.5f,
                           std::min(start_point.y(), end_point.y()) - 20.f);
     new_path.quadTo(control_point, end_point);
   }
-  else if (this->link_type == LinkType::JAGGED)
+  else if (link_type == LinkType::JAGGED)
   {
     int segments = 6; // number of zig-zag segments
     for (int i = 1; i <= segments; ++i)
@@ -220,63 +424,25 @@ void GraphicsLink::set_endpoints(const QPointF &start_point, const QPointF &end_
     new_path.lineTo(end_point);
   }
 
-  this->setPath(new_path);
+  return new_path;
 }
 
-void GraphicsLink::set_link_type(const LinkType &new_link_type)
+LinkType get_next_link_type(LinkType link_type)
 {
-  this->link_type = new_link_type;
-  this->update();
-}
-
-void GraphicsLink::set_pen_style(const Qt::PenStyle &new_pen_style)
-{
-  this->pen_style = new_pen_style;
-}
-
-QPainterPath GraphicsLink::shape() const
-{
-  QPainterPathStroker stroker;
-  stroker.setWidth(40);
-  QPainterPath widened_path = stroker.createStroke(path());
-  return widened_path.united(path());
-}
+  static const std::vector<LinkType> link_types = {LinkType::BROKEN_LINE,
+                                                   LinkType::CIRCUIT,
+                                                   LinkType::CUBIC,
+                                                   LinkType::DEPORTED,
+                                                   LinkType::LINEAR,
+                                                   LinkType::QUADRATIC};
 
-LinkType GraphicsLink::toggle_link_type()
-{
   // current link type in the list
-  auto it = std::find(this->link_types.begin(), this->link_types.end(), this->link_type);
-
-  size_t index = std::distance(this->link_types.begin(), it);
-  index = (index + 1) % this->link_types.size();
+  auto it = std::find(link_types.begin(), link_types.end(), link_type);
 
-  this->set_link_type(this->link_types[index]);
-  this->update_path();
-
-  return this->link_types[index];
-}
+  size_t index = std::distance(link_types.begin(), it);
+  index = (index + 1) % link_types.size();
 
-void GraphicsLink::update_path()
-{
-  // update path (only establisged ones, not the temporary one)
-  if (is_valid(this->node_out) && is_valid(this->node_in))
-  {
-    // guards
-    if (port_out_index >= (int)this->node_out->get_geometry().port_rects.size())
-      return;
-    if (port_in_index >= (int)this->node_in->get_geometry().port_rects.size())
-      return;
-
-    QPointF start_point = this->node_out->scenePos() + this->node_out->get_geometry()
-                                                           .port_rects[port_out_index]
-                                                           .center();
-    QPointF end_point = this->node_in->scenePos() +
-                        this->node_in->get_geometry().port_rects[port_in_index].center();
-
-    this->set_endpoints(start_point, end_point);
-  }
-
-  this->update();
+  return link_types[index];
 }
 
 } // namespace gngui
@@ -10,11 +10,13 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QPainter>
 
+#include "gnodegui/graph_scene.hpp"
 #include "gnodegui/graphics_link.hpp"
 #include "gnodegui/graphics_node.hpp"
 #include "gnodegui/icons/reload_icon.hpp"
 #include "gnodegui/icons/show_settings_icon.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
 #include "gnodegui/style.hpp"
 #include "gnodegui/utils.hpp"
 
@@ -22,14 +24,8 @@ namespace gngui
 {
 
 GraphicsNode::GraphicsNode(QPointer<NodeProxy> p_proxy, QGraphicsItem *parent)
-    : QGraphicsRectItem(parent), p_proxy(p_proxy)
+    : QGraphicsRectItem(parent)
 {
-  if (!this->p_proxy)
-  {
-    Logger::log()->error("GraphicsNode::GraphicsNode: input p_proxy is nullptr");
-    return;
-  }
-
   // item flags
   this->setFlag(QGraphicsItem::ItemIsSelectable, true);
   this->setFlag(QGraphicsItem::ItemIsMovable, true);
@@ -42,17 +38,10 @@ GraphicsNode::GraphicsNode(QPointer<NodeProxy> p_proxy, QGraphicsItem *parent)
   this->setOpacity(1.f);
   this->setZValue(0);
 
-  // tooltip
-  const std::string tooltip = this->p_proxy->get_tool_tip_text();
-  if (!tooltip.empty())
-    this->setToolTip(QString::fromStdString(tooltip));
-
-  // initialize port states
-  this->is_port_hovered.resize(this->get_nports());
-  this->connected_link_ref.resize(this->get_nports());
+  if (!p_proxy)
+    Logger::log()->error("GraphicsNode::GraphicsNode: input p_proxy is nullptr");
 
-  // geometry
-  this->update_geometry();
+  this->reset(p_proxy);
 }
 
 GraphicsNode::~GraphicsNode()
@@ -64,8 +53,13 @@ GraphicsNode::~GraphicsNode()
   this->setAcceptHoverEvents(false);
   this->setAcceptedMouseButtons(Qt::NoButton);
 
-  // destroy proxy widget safely
-  if (this->proxy_widget)
+  // destroy proxy widget safely. Widgets built by the factory belong to the node,
+  // the others are detached and left to their owner
+  if (this->widget_factory)
+  {
+    this->release_widget();
+  }
+  else if (this->proxy_widget)
   {
     this->proxy_widget->setWidget(nullptr);
     this->proxy_widget->deleteLater();
@@ -102,21 +96,13 @@ std::string GraphicsNode::get_data_type(int port_index) const
   return this->p_proxy->get_data_type(port_index);
 }
 
-const GraphicsNodeGeometry &GraphicsNode::get_geometry() const { return this->geometry; }
+ComputeState GraphicsNode::get_compute_state() const { return this->compute_state; }
 
-int GraphicsNode::get_hovered_port_index() const
-{
-  auto it = std::find(this->is_port_hovered.begin(), this->is_port_hovered.end(), true);
+uint64_t GraphicsNode::get_data_version() const { return this->data_version; }
 
-  // if found, calculate the index; otherwise, return -1
-  if (it != this->is_port_hovered.end())
-  {
-    int index = std::distance(this->is_port_hovered.begin(), it);
-    return index;
-  }
-  else
-    return -1;
-}
+const GraphicsNodeGeometry &GraphicsNode::get_geometry() const { return *this->geometry; }
+
+int GraphicsNode::get_hovered_port_index() const { return this->hovered_port_index; }
 
 std::string GraphicsNode::get_id() const
 {
@@ -126,6 +112,15 @@ std::string GraphicsNode::get_id() const
   return this->p_proxy->get_id();
 }
 
+bool GraphicsNode::get_is_node_computing() const
+{
+  return this->compute_state == ComputeState::RUNNING;
+}
+
+bool GraphicsNode::get_is_node_pinned() const { return this->is_node_pinned; }
+
+bool GraphicsNode::get_is_widget_visible() const { return this->is_widget_visible; }
+
 std::string GraphicsNode::get_main_category() const
 {
   std::string node_category = this->get_category();
@@ -133,6 +128,20 @@ std::string GraphicsNode::get_main_category() const
   return node_category.substr(0, pos);
 }
 
+size_t GraphicsNode::get_memory_usage() const
+{
+  size_t bytes = sizeof(GraphicsNode) + this->get_nports() * sizeof(GraphicsLink *);
+
+  if (this->data_type_connecting.capacity() >= sizeof(std::string))
+    bytes += this->data_type_connecting.capacity() + 1;
+
+  if (!this->widget_snapshot.isNull())
+    bytes += (size_t)this->widget_snapshot.width() * this->widget_snapshot.height() *
+             this->widget_snapshot.depth() / 8;
+
+  return bytes;
+}
+
 int GraphicsNode::get_nports() const
 {
   if (!this->p_proxy)
@@ -176,23 +185,32 @@ PortType GraphicsNode::get_port_type(int port_index) const
 
 const NodeProxy *GraphicsNode::get_proxy_ref() const { return this->p_proxy; }
 
-QSizeF GraphicsNode::get_widget_size() const
+std::function<QWidget *()> GraphicsNode::get_widget_factory() const
 {
-  QSizeF size = QSizeF();
+  return this->widget_factory;
+}
 
-  if (this->proxy_widget)
+QSizeF GraphicsNode::get_widget_size() const
+{
+  // live widget size, if not the last known size (snapshot / placeholder)
+  if (this->is_widget_live())
   {
     if (QWidget *widget = this->proxy_widget->widget())
-      size = widget->size();
+      return widget->size();
   }
 
-  return size;
+  return this->current_widget_size;
+}
+
+bool GraphicsNode::has_widget() const
+{
+  return this->proxy_widget || this->widget_factory;
 }
 
 void GraphicsNode::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
   this->is_node_hovered = true;
-  this->update();
+  this->update_border_band();
 
   QGraphicsRectItem::hoverEnterEvent(event);
 }
@@ -201,7 +219,7 @@ void GraphicsNode::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
   this->is_node_hovered = false;
   this->setCursor(Qt::ArrowCursor);
-  this->update();
+  this->update_border_band();
 
   QGraphicsRectItem::hoverLeaveEvent(event);
 }
@@ -212,18 +230,62 @@ void GraphicsNode::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
   QPointF scene_pos = this->mapToScene(pos);
   QPointF item_pos = scene_pos - this->scenePos();
 
+  // only repaint the port(s) whose hover state changed
+  const int previous_port_index = this->get_hovered_port_index();
+
   if (this->update_is_port_hovered(item_pos))
-    this->update();
+  {
+    this->update_port(previous_port_index);
+    this->update_port(this->get_hovered_port_index());
+  }
 
   QGraphicsRectItem::hoverMoveEvent(event);
 }
 
+void GraphicsNode::install_widget(QWidget *new_widget, QSize new_widget_size)
+{
+  // erase current parenting
+  if (new_widget->parentWidget())
+    new_widget->setParent(nullptr);
+
+  // clean-up existing container
+  this->release_widget();
+  this->widget_snapshot = QPixmap();
+
+  // eventually set widget
+  this->proxy_widget = new QGraphicsProxyWidget(this);
+  this->proxy_widget->setWidget(new_widget);
+
+  if (!new_widget_size.isValid())
+    new_widget_size = new_widget->sizeHint();
+  this->proxy_widget->resize(new_widget_size);
+
+  // update the geometry
+  this->update_geometry();
+  this->proxy_widget->setPos(this->geometry->widget_pos);
+  this->update();
+
+  if (this->p_callbacks && this->p_callbacks->widget_activated)
+    this->p_callbacks->widget_activated(this);
+}
+
 bool GraphicsNode::is_port_available(int port_index)
 {
   return this->get_port_type(port_index) == PortType::OUT ||
          !this->connected_link_ref[port_index];
 }
 
+bool GraphicsNode::is_read_only() const
+{
+  const GraphScene *p_scene = dynamic_cast<const GraphScene *>(this->scene());
+  return p_scene && p_scene->is_read_only();
+}
+
+bool GraphicsNode::is_widget_live() const
+{
+  return this->proxy_widget && this->proxy_widget->isVisible();
+}
+
 QVariant GraphicsNode::itemChange(GraphicsItemChange change, const QVariant &value)
 {
   if (change == QGraphicsItem::ItemSelectedHasChanged)
@@ -232,13 +294,13 @@ QVariant GraphicsNode::itemChange(GraphicsItemChange change, const QVariant &val
 
     if (new_selection_state)
     {
-      if (this->selected)
-        this->selected(this->get_id());
+      if (this->p_callbacks && this->p_callbacks->selected)
+        this->p_callbacks->selected(this->get_id());
     }
     else
     {
-      if (this->deselected)
-        this->deselected(this->get_id());
+      if (this->p_callbacks && this->p_callbacks->deselected)
+        this->p_callbacks->deselected(this->get_id());
     }
   }
 
@@ -280,6 +342,33 @@ nlohmann::json GraphicsNode::json_to() const
 
 void GraphicsNode::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
+  // while connecting, only the node under the cursor (if any) needs to
+  // know about it, the one hovered before is reset
+  if (this->has_connection_started && this->scene())
+  {
+    GraphicsNode *p_target = nullptr;
+
+    for (QGraphicsItem *item : this->scene()->items(event->scenePos()))
+      if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(item))
+      {
+        if (p_node != this)
+          p_target = p_node;
+        break;
+      }
+
+    if (p_target != this->p_connection_target && this->p_connection_target)
+      this->p_connection_target->reset_connection_hover();
+
+    this->p_connection_target = p_target;
+
+    if (p_target)
+      p_target->update_connection_hover(this, event->scenePos());
+  }
+
+  // no move while the graph is read-only
+  if (!this->has_connection_started && this->is_read_only())
+    return;
+
   // let the base class handle normal movement
   QGraphicsItem::mouseMoveEvent(event);
 }
@@ -290,7 +379,7 @@ void GraphicsNode::mousePressEvent(QGraphicsSceneMouseEvent *event)
   {
     int hovered_port_index = this->get_hovered_port_index();
 
-    if (hovered_port_index >= 0)
+    if (hovered_port_index >= 0 && !this->is_read_only())
     {
       Logger::log()->trace("GraphicsNode::mousePressEvent: connection_started {}:{}",
                            this->get_id(),
@@ -300,8 +389,18 @@ void GraphicsNode::mousePressEvent(QGraphicsSceneMouseEvent *event)
       this->setFlag(QGraphicsItem::ItemIsMovable, false);
       this->port_index_from = hovered_port_index;
       this->data_type_connecting = this->get_data_type(hovered_port_index);
-      if (this->connection_started)
-        this->connection_started(this, hovered_port_index);
+
+      // dim incompatible ports on the other nodes
+      for (QGraphicsItem *item : get_scene_items(this->scene()))
+        if (GraphicsNode *node = dynamic_cast<GraphicsNode *>(item))
+          if (node != this)
+          {
+            node->data_type_connecting = this->data_type_connecting;
+            node->update_ports();
+          }
+
+      if (this->p_callbacks && this->p_callbacks->connection_started)
+        this->p_callbacks->connection_started(this, hovered_port_index);
       event->accept();
     }
     else
@@ -314,8 +413,8 @@ void GraphicsNode::mousePressEvent(QGraphicsSceneMouseEvent *event)
   {
     QPointF pos = event->pos();
     QPointF scene_pos = this->mapToScene(pos);
-    if (this->right_clicked)
-      this->right_clicked(this->get_id(), scene_pos);
+    if (this->p_callbacks && this->p_callbacks->right_clicked)
+      this->p_callbacks->right_clicked(this->get_id(), scene_pos);
   }
 
   QGraphicsRectItem::mousePressEvent(event);
@@ -348,11 +447,11 @@ void GraphicsNode::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
                 p_target_node->get_id(),
                 hovered_port_index);
 
-            if (this->connection_finished)
-              this->connection_finished(this,
-                                        this->port_index_from,
-                                        p_target_node,
-                                        hovered_port_index);
+            if (this->p_callbacks && this->p_callbacks->connection_finished)
+              this->p_callbacks->connection_finished(this,
+                                                     this->port_index_from,
+                                                     p_target_node,
+                                                     hovered_port_index);
 
             is_dropped = false;
             break;
@@ -365,28 +464,38 @@ void GraphicsNode::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         }
       }
 
+      this->update_port(this->get_hovered_port_index());
       this->reset_is_port_hovered();
-      this->update();
 
       if (is_dropped)
       {
         Logger::log()->trace("GraphicsNode::mouseReleaseEvent connection_dropped {}",
                              this->get_id());
 
-        if (this->connection_dropped)
-          this->connection_dropped(this, this->port_index_from, event->scenePos());
+        if (this->p_callbacks && this->p_callbacks->connection_dropped)
+          this->p_callbacks->connection_dropped(this,
+                                                this->port_index_from,
+                                                event->scenePos());
       }
 
       this->has_connection_started = false;
 
-      // clean-up port color state
-      for (QGraphicsItem *item : this->scene()->items())
+      if (this->p_connection_target)
+      {
+        this->p_connection_target->reset_connection_hover();
+        this->p_connection_target = nullptr;
+      }
+
+      // clean-up port color state, nodes untouched by the connection
+      // attempt are skipped
+      for (QGraphicsItem *item : get_scene_items(this->scene()))
       {
         if (GraphicsNode *node = dynamic_cast<GraphicsNode *>(item))
-        {
-          node->data_type_connecting = "";
-          node->update();
-        }
+          if (!node->data_type_connecting.empty())
+          {
+            node->data_type_connecting = "";
+            node->update_ports();
+          }
       }
 
       this->setFlag(QGraphicsItem::ItemIsMovable, true);
@@ -396,37 +505,40 @@ void GraphicsNode::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
   QGraphicsRectItem::mouseReleaseEvent(event);
 }
 
-void GraphicsNode::on_compute_finished()
+void GraphicsNode::on_compute_finished(bool update_item)
 {
-  Logger::log()->trace("GraphicsNode::on_compute_finished, node {}", this->get_caption());
-  this->is_node_computing = false;
-  this->update();
+  this->data_version++;
+  this->set_compute_state(ComputeState::DONE, update_item);
+  this->update_thumbnail();
 }
 
-void GraphicsNode::on_compute_started()
+void GraphicsNode::on_compute_started(bool update_item)
 {
-  Logger::log()->trace("GraphicsNode::on_compute_started, node {}", this->get_caption());
-  this->is_node_computing = true;
-  this->update();
+  this->set_compute_state(ComputeState::RUNNING, update_item);
 }
 
-void GraphicsNode::paint(QPainter *painter,
+void GraphicsNode::paint(QPainter                       *painter,
                          const QStyleOptionGraphicsItem * /* option */,
-                         QWidget * /* widget */)
+                         QWidget                        *widget)
 {
+  GN_COUNTERS->node_paints++;
+
   if (!this->p_proxy)
     return;
 
   if (current_widget_size != this->get_widget_size())
     this->update_geometry();
 
+  // draft rendering while navigating: no text
+  const bool draft = is_draft_render(widget);
+
   painter->save();
 
   // --- Background rectangle
 
   painter->setBrush(QBrush(GN_STYLE->node.color_bg));
   painter->setPen(Qt::NoPen);
-  painter->drawRoundedRect(this->geometry.body_rect,
+  painter->drawRoundedRect(this->geometry->body_rect,
                            GN_STYLE->node.rounding_radius,
                            GN_STYLE->node.rounding_radius);
 
@@ -442,7 +554,7 @@ void GraphicsNode::paint(QPainter *painter,
 
     float w = GN_STYLE->node.pen_width_selected;
 
-    painter->drawRoundedRect(this->geometry.body_rect.adjusted(-w, -w, w, w),
+    painter->drawRoundedRect(this->geometry->body_rect.adjusted(-w, -w, w, w),
                              GN_STYLE->node.rounding_radius,
                              GN_STYLE->node.rounding_radius);
 
@@ -453,9 +565,12 @@ void GraphicsNode::paint(QPainter *painter,
   // --- Caption
 
   // Set pen based on whether the node is selected or not
-  painter->setPen(this->isSelected() ? GN_STYLE->node.color_selected
-                                     : GN_STYLE->node.color_caption);
-  painter->drawText(this->geometry.caption_pos, this->get_caption().c_str());
+  if (!draft)
+  {
+    painter->setPen(this->isSelected() ? GN_STYLE->node.color_selected
+                                       : GN_STYLE->node.color_caption);
+    painter->drawText(this->geometry->caption_pos, this->get_caption().c_str());
+  }
 
   // --- Header
 
@@ -465,7 +580,16 @@ void GraphicsNode::paint(QPainter *painter,
   if (GN_STYLE->node.color_category.contains(main_category))
     header_color = GN_STYLE->node.color_category.at(main_category);
 
-  if (this->is_node_computing)
+  // compute telemetry heatmap in place of the category color
+  const GraphScene       *p_scene = dynamic_cast<const GraphScene *>(this->scene());
+  const TelemetryOverlay *p_overlay = p_scene ? &p_scene->get_telemetry_overlay()
+                                              : nullptr;
+  const bool has_overlay = p_overlay && p_overlay->is_visible && this->p_telemetry;
+
+  if (has_overlay)
+    header_color = p_overlay->get_color(this->p_telemetry->get(p_overlay->metric));
+
+  if (this->compute_state == ComputeState::RUNNING)
   {
     QColor dim_color = header_color;
     dim_color.setAlphaF(0.5f * header_color.alphaF());
@@ -478,7 +602,7 @@ void GraphicsNode::paint(QPainter *painter,
 
   painter->setPen(Qt::NoPen);
   QPainterPath path;
-  QRectF       rect = this->geometry.header_rect;
+  QRectF       rect = this->geometry->header_rect;
   float        radius = GN_STYLE->node.rounding_radius;
 
   path.moveTo(rect.left(), rect.bottom());
@@ -491,19 +615,66 @@ void GraphicsNode::paint(QPainter *painter,
 
   painter->drawPath(path);
 
+  // compute status strip, at the bottom of the header
+  QColor status_color = Qt::transparent;
+
+  switch (this->compute_state)
+  {
+  case ComputeState::QUEUED:
+    status_color = GN_STYLE->node.color_compute_queued;
+    break;
+
+  case ComputeState::RUNNING:
+    status_color = GN_STYLE->node.color_compute_running;
+    break;
+
+  case ComputeState::FAILED:
+    status_color = GN_STYLE->node.color_compute_failed;
+    break;
+
+  case ComputeState::CACHED:
+    status_color = GN_STYLE->node.color_compute_cached;
+    break;
+
+  default:
+    break;
+  }
+
+  if (status_color.alpha() > 0)
+  {
+    const float h = GN_STYLE->node.compute_status_width;
+    painter->setBrush(status_color);
+    painter->drawRect(QRectF(rect.left(), rect.bottom() - h, rect.width(), h));
+  }
+
+  if (has_overlay && !draft)
+  {
+    painter->setPen(GN_STYLE->node.color_heatmap_text);
+    painter->drawText(rect,
+                      Qt::AlignCenter,
+                      this->p_telemetry->format(p_overlay->metric).c_str());
+    painter->setPen(Qt::NoPen);
+  }
+
   // --- Border
 
+  const bool is_critical = p_overlay && p_overlay->is_critical_path_visible &&
+                           this->p_telemetry && this->p_telemetry->is_critical;
+
   painter->setBrush(Qt::NoBrush);
   if (this->isSelected())
     painter->setPen(
         QPen(GN_STYLE->node.color_selected, GN_STYLE->node.pen_width_selected));
+  else if (is_critical)
+    painter->setPen(
+        QPen(GN_STYLE->node.color_critical, GN_STYLE->node.pen_width_selected));
   else if (this->is_node_hovered)
     painter->setPen(
         QPen(GN_STYLE->node.color_border_hovered, GN_STYLE->node.pen_width_hovered));
   else
     painter->setPen(QPen(GN_STYLE->node.color_border, GN_STYLE->node.pen_width));
 
-  painter->drawRoundedRect(this->geometry.body_rect,
+  painter->drawRoundedRect(this->geometry->body_rect,
                            GN_STYLE->node.rounding_radius,
                            GN_STYLE->node.rounding_radius);
 
@@ -516,13 +687,16 @@ void GraphicsNode::paint(QPainter *painter,
                                                               : Qt::AlignRight;
 
     // Draw port labels
-    painter->setPen(Qt::white); // Assuming labels are always white
-    painter->drawText(this->geometry.port_label_rects[k],
-                      align_flag,
-                      this->get_port_caption(k).c_str());
+    if (!draft)
+    {
+      painter->setPen(Qt::white); // Assuming labels are always white
+      painter->drawText(this->geometry->port_label_rects[k],
+                        align_flag,
+                        this->get_port_caption(k).c_str());
+    }
 
     // Port appearance when selected or not
-    if (this->is_port_hovered[k])
+    if (k == this->hovered_port_index)
       painter->setPen(
           QPen(GN_STYLE->node.color_port_hovered, GN_STYLE->node.pen_width_hovered));
     else if (this->is_node_hovered)
@@ -543,102 +717,225 @@ void GraphicsNode::paint(QPainter *painter,
       painter->setBrush(get_color_from_data_type(data_type));
 
     // Draw the port as a circle (ellipse with equal width and height)
-    painter->drawEllipse(this->geometry.port_rects[k].center(), port_radius, port_radius);
+    painter->drawEllipse(this->geometry->port_rects[k].center(),
+                         port_radius,
+                         port_radius);
+  }
+
+  // --- Port data thumbnail
+
+  if (this->thumbnail_port_index >= 0)
+  {
+    const QRectF  rect = this->geometry->thumbnail_rect;
+    const QImage *p_image = this->p_thumbnail_cache->get(
+        this->get_id(),
+        this->thumbnail_port_index,
+        this->data_version,
+        this->get_data_type(this->thumbnail_port_index),
+        this->p_proxy->get_data_ref(this->thumbnail_port_index),
+        rect.size().toSize());
+
+    if (p_image && !p_image->isNull())
+    {
+      // keep aspect ratio
+      QSizeF size = QSizeF(p_image->size()).scaled(rect.size(), Qt::KeepAspectRatio);
+      QRectF target(QPointF(0.f, 0.f), size);
+      target.moveCenter(rect.center());
+      painter->drawImage(target, *p_image);
+    }
+    else
+    {
+      painter->setPen(Qt::NoPen);
+      painter->setBrush(GN_STYLE->node.color_bg_light);
+      painter->drawRect(rect);
+    }
+  }
+
+  // --- Widget snapshot, drawn in place of a widget that is not live
+
+  if (this->has_widget() && !this->is_widget_live())
+  {
+    QRectF rect(this->geometry->widget_pos, this->current_widget_size);
+
+    if (!this->widget_snapshot.isNull())
+    {
+      painter->drawPixmap(rect,
+                          this->widget_snapshot,
+                          QRectF(this->widget_snapshot.rect()));
+    }
+    else
+    {
+      painter->setPen(Qt::NoPen);
+      painter->setBrush(GN_STYLE->node.color_bg_light);
+      painter->drawRect(rect);
+    }
   }
 
   // --- Comment
 
   std::string comment = this->p_proxy->get_comment();
 
-  if (!comment.empty())
+  if (!comment.empty() && !draft)
   {
-    if (comment != this->current_comment)
+    if (std::hash<std::string>{}(comment) != this->comment_hash)
       this->update_geometry();
 
     painter->setPen(GN_STYLE->node.color_comment);
-    painter->drawText(this->geometry.comment_rect,
+    painter->drawText(this->geometry->comment_rect,
                       Qt::TextWordWrap | Qt::AlignLeft | Qt::AlignTop,
                       comment.c_str());
-
-    this->current_comment = comment;
   }
 
   painter->restore();
 }
 
-void GraphicsNode::set_is_node_pinned(bool new_state)
+void GraphicsNode::release_widget()
 {
-  this->is_node_pinned = new_state;
-  this->update();
+  if (!this->proxy_widget)
+    return;
+
+  QWidget *old = this->proxy_widget->widget();
+  this->proxy_widget->setWidget(nullptr);
+  if (old)
+    old->deleteLater();
+  this->proxy_widget->deleteLater();
+  this->proxy_widget = nullptr;
 }
 
-void GraphicsNode::set_is_port_connected(int port_index, GraphicsLink *p_link)
+void GraphicsNode::reset(QPointer<NodeProxy> new_p_proxy)
 {
-  this->connected_link_ref[port_index] = p_link;
+  // as on deletion, a factory widget is released, the others are detached and left
+  // to their owner
+  if (this->widget_factory)
+  {
+    this->release_widget();
+  }
+  else if (this->proxy_widget)
+  {
+    this->proxy_widget->setWidget(nullptr);
+    this->proxy_widget->setParentItem(nullptr);
+    this->proxy_widget->deleteLater();
+    this->proxy_widget = nullptr;
+  }
+
+  this->p_callbacks = nullptr;
+  this->p_proxy = new_p_proxy;
+  this->p_connection_target = nullptr;
+  this->data_type_connecting.clear();
+  this->current_widget_size = QSizeF();
+  this->widget_factory = nullptr;
+  this->widget_snapshot = QPixmap();
+  this->p_thumbnail_cache = nullptr;
+  this->p_telemetry = nullptr;
+  this->data_version = 0;
+  this->hovered_port_index = -1;
+  this->port_index_from = -1;
+  this->thumbnail_port_index = -1;
+  this->is_node_dragged = false;
+  this->is_node_hovered = false;
+  this->is_node_pinned = false;
+  this->compute_state = ComputeState::IDLE;
+  this->is_widget_visible = true;
+  this->has_connection_started = false;
+
+  this->setSelected(false);
+  this->setVisible(true);
+  this->setFlag(QGraphicsItem::ItemIsMovable, true);
+  this->setPos(0.f, 0.f);
+
+  // no proxy for pooled nodes, kept aside until reused
+  if (!this->p_proxy)
+    return;
+
+  // tooltip
+  const std::string tooltip = this->p_proxy->get_tool_tip_text();
+  this->setToolTip(QString::fromStdString(tooltip));
+
+  // initialize port states, the array is kept if large enough
+  const int nports = this->get_nports();
+
+  if (nports > this->nports_capacity)
+  {
+    this->connected_link_ref = std::make_unique<GraphicsLink *[]>(nports);
+    this->nports_capacity = nports;
+  }
+  else
+    std::fill_n(this->connected_link_ref.get(), nports, nullptr);
+
+  // geometry
+  this->update_geometry();
 }
 
-void GraphicsNode::reset_is_port_hovered()
+void GraphicsNode::set_callbacks(const GraphicsNodeCallbacks *new_p_callbacks)
 {
-  this->is_port_hovered.assign(this->is_port_hovered.size(), false);
+  this->p_callbacks = new_p_callbacks;
 }
 
-bool GraphicsNode::sceneEventFilter(QGraphicsItem *watched, QEvent *event)
+void GraphicsNode::set_compute_state(ComputeState new_state, bool update_item)
 {
-  // Try to cast the watched item to a GraphicsNode
-  if (GraphicsNode *p_node = dynamic_cast<GraphicsNode *>(watched))
-  {
-    // Check for mouse move while connection started
-    if (event->type() == QEvent::GraphicsSceneMouseMove && p_node &&
-        p_node->has_connection_started)
-    {
-      QGraphicsSceneMouseEvent *mouse_event = static_cast<QGraphicsSceneMouseEvent *>(
-          event);
-      QPointF item_pos = mouse_event->scenePos() - this->scenePos();
+  if (new_state == this->compute_state)
+    return;
 
-      // Update current data type of the building connection
-      if (p_node && this->data_type_connecting != p_node->data_type_connecting)
-      {
-        this->data_type_connecting = p_node->data_type_connecting;
-        this->update();
-      }
+  this->compute_state = new_state;
 
-      if (!p_node)
-        return false; // one got deleted during update
+  if (update_item)
+    this->update(this->geometry->header_rect);
+}
 
-      // Update hovering port status
-      if (this->update_is_port_hovered(item_pos))
-      {
-        for (int k = 0; k < this->get_nports(); k++)
-        {
-          if (this->is_port_hovered[k])
-          {
-            if (!p_node)
-              break; // avoid deref if deleted mid-loop
+void GraphicsNode::set_data_version(uint64_t new_data_version)
+{
+  this->data_version = new_data_version;
+  this->update_thumbnail();
+}
 
-            int      from_pidx = p_node->port_index_from;
-            PortType from_ptype = p_node->get_port_type(from_pidx);
-            PortType to_ptype = this->get_port_type(k);
+void GraphicsNode::set_telemetry(const NodeTelemetry *new_p_telemetry)
+{
+  this->p_telemetry = new_p_telemetry;
+}
 
-            std::string from_pdata = p_node->get_data_type(from_pidx);
-            std::string to_pdata = this->get_data_type(k);
+void GraphicsNode::set_is_node_pinned(bool new_state)
+{
+  this->is_node_pinned = new_state;
+  this->update_border_band();
+}
 
-            // Incompatible or same type → deactivate hover
-            if (from_ptype == to_ptype || from_pdata != to_pdata)
-              this->is_port_hovered[k] = false;
-          }
-        }
-      }
-    }
-  }
+void GraphicsNode::set_is_port_connected(int port_index, GraphicsLink *p_link)
+{
+  this->connected_link_ref[port_index] = p_link;
+}
 
-  return QGraphicsRectItem::sceneEventFilter(watched, event);
+void GraphicsNode::reset_connection_hover()
+{
+  this->update_port(this->get_hovered_port_index());
+  this->reset_is_port_hovered();
 }
 
+void GraphicsNode::reset_is_port_hovered() { this->hovered_port_index = -1; }
+
 void GraphicsNode::set_p_proxy(QPointer<NodeProxy> new_p_proxy)
 {
   this->p_proxy = new_p_proxy;
 }
 
+void GraphicsNode::set_thumbnail_cache(ThumbnailCache *new_p_thumbnail_cache)
+{
+  this->p_thumbnail_cache = new_p_thumbnail_cache;
+  this->thumbnail_port_index = -1;
+
+  // thumbnail of the first output with a registered converter, if any
+  if (this->p_thumbnail_cache)
+    for (int k = 0; k < this->get_nports(); k++)
+      if (this->get_port_type(k) == PortType::OUT &&
+          this->p_thumbnail_cache->has_converter(this->get_data_type(k)))
+      {
+        this->thumbnail_port_index = k;
+        break;
+      }
+
+  this->update_geometry();
+  this->update();
+}
+
 void GraphicsNode::set_widget(QWidget *new_widget, QSize new_widget_size)
 {
   Logger::log()->debug("GraphicsNode::set_widget");
@@ -646,31 +943,63 @@ void GraphicsNode::set_widget(QWidget *new_widget, QSize new_widget_size)
   if (!this->p_proxy || !new_widget)
     return;
 
-  // erase current parenting
-  if (new_widget->parentWidget())
-    new_widget->setParent(nullptr);
+  // host widget, not to be released nor rebuilt by a previous factory
+  this->widget_factory = nullptr;
+  this->install_widget(new_widget, new_widget_size);
+}
 
-  // clean-up existing container
-  if (this->proxy_widget)
-  {
-    QWidget *old = this->proxy_widget->widget();
-    this->proxy_widget->setWidget(nullptr);
-    if (old)
-      old->deleteLater();
-    this->proxy_widget->deleteLater();
-  }
+void GraphicsNode::set_widget_factory(std::function<QWidget *()> new_widget_factory,
+                                      QSize                      widget_size)
+{
+  Logger::log()->debug("GraphicsNode::set_widget_factory");
 
-  // eventually set widget
-  this->proxy_widget = new QGraphicsProxyWidget(this);
-  this->proxy_widget->setWidget(new_widget);
+  this->release_widget();
+  this->widget_snapshot = QPixmap();
+  this->widget_factory = new_widget_factory;
 
-  if (!new_widget_size.isValid())
-    new_widget_size = new_widget->sizeHint();
-  this->proxy_widget->resize(new_widget_size);
+  // the widget is only created when the node becomes visible, its
+  // size is used in the meantime to reserve room in the node body
+  if (widget_size.isValid())
+    this->current_widget_size = widget_size;
 
-  // update the geometry
   this->update_geometry();
-  this->proxy_widget->setPos(this->geometry.widget_pos);
+  this->update();
+}
+
+void GraphicsNode::set_widget_live(bool new_state)
+{
+  if (new_state == this->is_widget_live())
+    return;
+
+  if (new_state)
+  {
+    if (this->proxy_widget)
+    {
+      this->proxy_widget->setVisible(true);
+
+      if (this->p_callbacks && this->p_callbacks->widget_activated)
+        this->p_callbacks->widget_activated(this);
+    }
+    else if (this->widget_factory)
+    {
+      // lazy creation, 'install_widget' takes care of the notification
+      if (QWidget *new_widget = this->widget_factory())
+        this->install_widget(new_widget, this->current_widget_size.toSize());
+    }
+  }
+  else
+  {
+    // keep a snapshot to be drawn in place of the widget
+    if (QWidget *widget = this->proxy_widget->widget())
+      this->widget_snapshot = widget->grab();
+
+    // widgets that can be rebuilt are released, the others are only hidden
+    if (this->widget_factory)
+      this->release_widget();
+    else
+      this->proxy_widget->setVisible(false);
+  }
+
   this->update();
 }
 
@@ -690,6 +1019,54 @@ void GraphicsNode::set_widget_visibility(bool is_visible)
   this->update();
 }
 
+void GraphicsNode::update_border_band()
+{
+  // band around the body border, wide enough to cover the port
+  // circles (centered on the border) and the outer pinned border
+  const float w = std::max(GN_STYLE->node.port_radius + GN_STYLE->node.pen_width_hovered,
+                           3.f * GN_STYLE->node.pen_width_selected) +
+                  1.f;
+
+  const QRectF outer = this->geometry->body_rect.adjusted(-w, -w, w, w);
+  const QRectF inner = this->geometry->body_rect.adjusted(w, w, -w, -w);
+
+  // top, bottom, left, right
+  this->update(QRectF(outer.topLeft(), QPointF(outer.right(), inner.top())));
+  this->update(QRectF(QPointF(outer.left(), inner.bottom()), outer.bottomRight()));
+  this->update(QRectF(QPointF(outer.left(), inner.top()), inner.bottomLeft()));
+  this->update(QRectF(inner.topRight(), QPointF(outer.right(), inner.bottom())));
+}
+
+void GraphicsNode::update_connection_hover(GraphicsNode *p_from, QPointF scene_pos)
+{
+  QPointF item_pos = scene_pos - this->scenePos();
+
+  // update hovering port status
+  const int previous_port_index = this->get_hovered_port_index();
+
+  if (this->update_is_port_hovered(item_pos))
+  {
+    this->update_port(previous_port_index);
+    this->update_port(this->get_hovered_port_index());
+
+    const int k = this->hovered_port_index;
+
+    if (k >= 0)
+    {
+      int      from_pidx = p_from->port_index_from;
+      PortType from_ptype = p_from->get_port_type(from_pidx);
+      PortType to_ptype = this->get_port_type(k);
+
+      std::string from_pdata = p_from->get_data_type(from_pidx);
+      std::string to_pdata = this->get_data_type(k);
+
+      // incompatible or same type → deactivate hover
+      if (from_ptype == to_ptype || from_pdata != to_pdata)
+        this->hovered_port_index = -1;
+    }
+  }
+}
+
 void GraphicsNode::update_geometry()
 {
   if (!this->p_proxy)
@@ -697,30 +1074,42 @@ void GraphicsNode::update_geometry()
 
   // determine widget size (if any)
   QSizeF widget_size = this->get_widget_size();
+  this->current_widget_size = widget_size;
+
+  // thumbnail room (if any)
+  QSizeF thumbnail_size = QSizeF(0.f, 0.f);
+  if (this->thumbnail_port_index >= 0)
+    thumbnail_size = QSizeF(GN_STYLE->node.thumbnail_size, GN_STYLE->node.thumbnail_size);
 
   // geometry
-  this->geometry = GraphicsNodeGeometry(this->p_proxy, widget_size);
-  this->setRect(0.f, 0.f, this->geometry.full_width, this->geometry.full_height);
+  this->geometry = GraphicsNodeGeometry::get_shared(this->p_proxy,
+                                                   widget_size,
+                                                   thumbnail_size);
+  this->comment_hash = std::hash<std::string>{}(this->p_proxy->get_comment());
+  this->setRect(0.f, 0.f, this->geometry->full_width, this->geometry->full_height);
+
+  // the widget follows the geometry
+  if (this->proxy_widget)
+    this->proxy_widget->setPos(this->geometry->widget_pos);
 }
 
 bool GraphicsNode::update_is_port_hovered(QPointF item_pos)
 {
   // set hover state
-  for (size_t k = 0; k < this->geometry.port_rects.size(); k++)
-    if (this->geometry.port_rects[k].contains(item_pos))
+  for (int k = 0; k < (int)this->geometry->port_rects.size(); k++)
+    if (this->geometry->port_rects[k].contains(item_pos))
     {
-      this->is_port_hovered[k] = true;
+      this->hovered_port_index = k;
       return true;
     }
 
-  // if we end up here and one the flag is still true, it means we
-  // just left a hovered port
-  for (size_t k = 0; k < this->geometry.port_rects.size(); k++)
-    if (this->is_port_hovered[k])
-    {
-      this->is_port_hovered[k] = false;
-      return true;
-    }
+  // if we end up here and a port is still hovered, it means we just
+  // left it
+  if (this->hovered_port_index >= 0)
+  {
+    this->hovered_port_index = -1;
+    return true;
+  }
 
   return false;
 }
@@ -730,7 +1119,7 @@ void GraphicsNode::update_links()
   if (!this->scene())
     return;
 
-  for (QGraphicsItem *item : this->scene()->items())
+  for (QGraphicsItem *item : get_scene_items(this->scene()))
     if (GraphicsLink *p_link = dynamic_cast<GraphicsLink *>(item))
     {
       if (p_link->get_node_out() == this || p_link->get_node_in() == this)
@@ -738,6 +1127,27 @@ void GraphicsNode::update_links()
     }
 }
 
+void GraphicsNode::update_thumbnail()
+{
+  if (this->thumbnail_port_index >= 0)
+    this->update(this->geometry->thumbnail_rect);
+}
+
+void GraphicsNode::update_port(int port_index)
+{
+  if (port_index < 0 || port_index >= (int)this->geometry->port_rects.size())
+    return;
+
+  const float w = GN_STYLE->node.pen_width_hovered + 1.f;
+  this->update(this->geometry->port_rects[port_index].adjusted(-w, -w, w, w));
+}
+
+void GraphicsNode::update_ports()
+{
+  for (int k = 0; k < (int)this->geometry->port_rects.size(); k++)
+    this->update_port(k);
+}
+
 // --- helper
 
 bool is_valid(GraphicsNode *node) { return node && node->scene() != nullptr; }
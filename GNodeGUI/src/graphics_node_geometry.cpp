@@ -1,16 +1,23 @@
 /* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
 #include <QFontMetrics>
 
 #include "gnodegui/graphics_node_geometry.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
 #include "gnodegui/style.hpp"
 
 namespace gngui
 {
 
-GraphicsNodeGeometry::GraphicsNodeGeometry(NodeProxy *p_node_proxy, QSizeF widget_size)
+GraphicsNodeGeometry::GraphicsNodeGeometry(NodeProxy *p_node_proxy,
+                                           QSizeF     widget_size,
+                                           QSizeF     thumbnail_size)
     : p_node_proxy(p_node_proxy)
 {
   if (!p_node_proxy)
@@ -26,12 +33,13 @@ GraphicsNodeGeometry::GraphicsNodeGeometry(NodeProxy *p_node_proxy, QSizeF widge
 
   // in this order...
   this->compute_base_metrics(fm);
-  this->compute_node_width(widget_size);
+  this->compute_node_width(widget_size, thumbnail_size);
   this->compute_caption(fm);
   this->compute_comment_height(fm, this->p_node_proxy->get_comment());
-  this->compute_full_dimensions(widget_size);
+  this->compute_full_dimensions(widget_size, thumbnail_size);
   this->compute_body_and_header();
   this->compute_ports(fm);
+  this->compute_thumbnail(thumbnail_size);
   this->compute_widget_position();
 }
 
@@ -88,7 +96,8 @@ void GraphicsNodeGeometry::compute_comment_height(const QFontMetrics &fm,
   this->comment_height = rect.height();
 }
 
-void GraphicsNodeGeometry::compute_full_dimensions(const QSizeF &widget_size)
+void GraphicsNodeGeometry::compute_full_dimensions(const QSizeF &widget_size,
+                                                   const QSizeF &thumbnail_size)
 {
   float min_width_caption = this->caption_size.width() + 2.f * GN_STYLE->node.padding;
   this->full_width = std::max(min_width_caption, this->node_width) + 2.f * this->margin;
@@ -101,11 +110,19 @@ void GraphicsNodeGeometry::compute_full_dimensions(const QSizeF &widget_size)
     this->full_height += widget_size.height() +
                          2.f * GN_STYLE->node.padding_widget_height;
   }
+
+  if (thumbnail_size.height() > 0)
+  {
+    this->full_height += thumbnail_size.height() +
+                         2.f * GN_STYLE->node.padding_widget_height;
+  }
 }
 
-void GraphicsNodeGeometry::compute_node_width(const QSizeF &widget_size)
+void GraphicsNodeGeometry::compute_node_width(const QSizeF &widget_size,
+                                              const QSizeF &thumbnail_size)
 {
-  float min_from_widget = widget_size.width() + 2.f * GN_STYLE->node.padding_widget_width;
+  float min_from_widget = std::max(widget_size.width(), thumbnail_size.width()) +
+                          2.f * GN_STYLE->node.padding_widget_width;
   this->node_width = std::max(GN_STYLE->node.width, (float)min_from_widget);
 }
 
@@ -134,10 +151,85 @@ void GraphicsNodeGeometry::compute_ports(const QFontMetrics &fm)
   this->ports_end_y = y;
 }
 
+void GraphicsNodeGeometry::compute_thumbnail(const QSizeF &thumbnail_size)
+{
+  this->thumbnail_end_y = this->ports_end_y;
+
+  if (thumbnail_size.height() <= 0)
+    return;
+
+  // centered right below the ports
+  float x = this->margin + 0.5f * (this->node_width - thumbnail_size.width());
+  float y = this->ports_end_y + GN_STYLE->node.padding_widget_height;
+
+  this->thumbnail_rect = QRectF(QPointF(x, y), thumbnail_size);
+  this->thumbnail_end_y = this->thumbnail_rect.bottom() +
+                          GN_STYLE->node.padding_widget_height;
+}
+
 void GraphicsNodeGeometry::compute_widget_position()
 {
-  this->widget_pos = QPointF(this->margin + GN_STYLE->node.padding_widget_width,
-                             this->ports_end_y + GN_STYLE->node.padding_widget_height);
+  float y = this->thumbnail_end_y + GN_STYLE->node.padding_widget_height;
+  this->widget_pos = QPointF(this->margin + GN_STYLE->node.padding_widget_width, y);
+}
+
+size_t GraphicsNodeGeometry::get_memory_usage() const
+{
+  const size_t nrects = this->port_label_rects.capacity() + this->port_rects.capacity();
+  return sizeof(GraphicsNodeGeometry) + nrects * sizeof(QRectF);
+}
+
+std::shared_ptr<const GraphicsNodeGeometry> GraphicsNodeGeometry::get_shared(
+    NodeProxy *p_node_proxy,
+    QSizeF     widget_size,
+    QSizeF     thumbnail_size)
+{
+  static const auto empty = std::make_shared<const GraphicsNodeGeometry>();
+
+  // entries are kept as long as a node uses them, expired ones are
+  // swept whenever the table has doubled since the last sweep
+  static std::unordered_map<std::string, std::weak_ptr<const GraphicsNodeGeometry>>
+                cache;
+  static size_t sweep_size = 64;
+
+  if (!p_node_proxy)
+    return empty;
+
+  // layout key
+  std::string key = p_node_proxy->get_caption() + '\x1f' + p_node_proxy->get_comment() +
+                    '\x1f';
+
+  for (int k = 0; k < p_node_proxy->get_nports(); k++)
+    key += p_node_proxy->get_port_type(k) == PortType::IN ? 'i' : 'o';
+
+  key += '\x1f' + std::to_string(widget_size.width()) + 'x' +
+         std::to_string(widget_size.height()) + '\x1f' +
+         std::to_string(thumbnail_size.width()) + 'x' +
+         std::to_string(thumbnail_size.height());
+
+  std::weak_ptr<const GraphicsNodeGeometry> &entry = cache[key];
+
+  if (auto p_geometry = entry.lock())
+  {
+    GN_COUNTERS->geometry_cache_hits++;
+    return p_geometry;
+  }
+
+  GN_COUNTERS->geometry_computations++;
+
+  auto p_geometry = std::make_shared<GraphicsNodeGeometry>(p_node_proxy,
+                                                           widget_size,
+                                                           thumbnail_size);
+  p_geometry->p_node_proxy = nullptr; // shared, the proxy is not kept
+  entry = p_geometry;
+
+  if (cache.size() > sweep_size)
+  {
+    std::erase_if(cache, [](const auto &item) { return item.second.expired(); });
+    sweep_size = std::max((size_t)64, 2 * cache.size());
+  }
+
+  return p_geometry;
 }
 
 } // namespace gngui
@@ -2,13 +2,22 @@
  * Public License. The full license is in the file LICENSE, distributed with
  * this software. */
 #include <QGraphicsDropShadowEffect>
+#include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
+#include <QImage>
+#include <QPainter>
 #include <QPainterPath>
 #include <QPen>
 #include <QToolTip>
 
 #include "gnodegui/icons/abstract_icon.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/utils.hpp"
+
+// drop shadow parameters, baked into the atlas
+#define ICON_SHADOW_OFFSET 4.f
+#define ICON_SHADOW_BLUR_RADIUS 20.f
+#define ICON_HOVERED_OPACITY 0.5f
 
 namespace gngui
 {
@@ -27,18 +36,30 @@ AbstractIcon::AbstractIcon(float          width,
   pen.setWidth(this->pen_width);
   pen.setCapStyle(Qt::RoundCap);
   this->setPen(pen);
+}
+
+QRectF AbstractIcon::boundingRect() const
+{
+  // room for the largest pen (pressed state) and for the drop shadow
+  const qreal hw = 0.5f * (this->pen_width + 1.f);
+  QRectF      rect = this->path().controlPointRect().adjusted(-hw, -hw, hw, hw);
 
-  auto effect = new QGraphicsDropShadowEffect;
-  effect->setOffset(4, 4);
-  effect->setBlurRadius(20);
-  effect->setColor(Qt::black);
-  this->setGraphicsEffect(effect);
+  rect |= rect.translated(ICON_SHADOW_OFFSET, ICON_SHADOW_OFFSET)
+              .adjusted(-ICON_SHADOW_BLUR_RADIUS,
+                        -ICON_SHADOW_BLUR_RADIUS,
+                        ICON_SHADOW_BLUR_RADIUS,
+                        ICON_SHADOW_BLUR_RADIUS);
+
+  return QRectF(rect.toAlignedRect());
 }
 
 void AbstractIcon::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
-  Q_UNUSED(event);
-  this->setOpacity(0.5f * this->pen_opacity);
+  // toolbar of another view sharing the scene
+  if (!is_overlay_drawn_in(this, event->widget()))
+    return;
+
+  this->set_state(IconState::HOVERED);
   QToolTip::showText(event->screenPos(), this->tooltip, nullptr);
   QGraphicsPathItem::hoverEnterEvent(event);
 }
@@ -46,11 +67,7 @@ void AbstractIcon::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 void AbstractIcon::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
   Q_UNUSED(event);
-  this->setOpacity(this->pen_opacity);
-
-  QPen pen = this->pen();
-  pen.setWidth(this->pen_width);
-  this->setPen(pen);
+  this->set_state(IconState::NORMAL);
 
   QToolTip::hideText();
   QGraphicsPathItem::hoverLeaveEvent(event);
@@ -58,13 +75,16 @@ void AbstractIcon::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 
 void AbstractIcon::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
-  if (event->button() == Qt::LeftButton)
+  // toolbar of another view sharing the scene, items below get the event
+  if (!is_overlay_drawn_in(this, event->widget()))
   {
-    QPen pen = this->pen();
-    pen.setWidth(this->pen_width + 1.f);
-    this->setPen(pen);
-    this->setOpacity(this->pen_opacity);
+    event->ignore();
+    return;
+  }
 
+  if (event->button() == Qt::LeftButton)
+  {
+    this->set_state(IconState::PRESSED);
     Q_EMIT this->hit_icon();
   }
   QGraphicsPathItem::mousePressEvent(event);
@@ -73,12 +93,96 @@ void AbstractIcon::mousePressEvent(QGraphicsSceneMouseEvent *event)
 void AbstractIcon::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
   Q_UNUSED(event);
+  this->set_state(this->isUnderMouse() ? IconState::HOVERED : IconState::NORMAL);
+  QGraphicsPathItem::mouseReleaseEvent(event);
+}
 
-  QPen pen = this->pen();
-  pen.setWidth(this->pen_width);
-  this->setPen(pen);
+void AbstractIcon::paint(QPainter                       *painter,
+                         const QStyleOptionGraphicsItem *option,
+                         QWidget                        *widget)
+{
+  Q_UNUSED(option);
 
-  QGraphicsPathItem::mouseReleaseEvent(event);
+  if (!is_overlay_drawn_in(this, widget))
+    return;
+
+  // the atlas is only (re)built if the target screen or the path changed (see
+  // set_icon_path)
+  const qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.f;
+
+  if (this->atlas.isNull() || this->atlas_dpr != dpr)
+    this->render_atlas(dpr);
+
+  // one cell per state, side by side
+  const qreal  cell_width = this->atlas.width() / 3.f;
+  const QRectF source(int(this->state) * cell_width,
+                      0.f,
+                      cell_width,
+                      this->atlas.height());
+
+  painter->drawPixmap(this->boundingRect(), this->atlas, source);
+}
+
+void AbstractIcon::render_atlas(qreal device_pixel_ratio)
+{
+  Logger::log()->trace("AbstractIcon::render_atlas: dpr {}", device_pixel_ratio);
+
+  const QRectF rect = this->boundingRect();
+  const QSize  cell_size = (rect.size() * device_pixel_ratio).toSize();
+
+  QImage image(3 * cell_size.width(),
+               cell_size.height(),
+               QImage::Format_ARGB32_Premultiplied);
+  image.fill(Qt::transparent);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+  for (int k = IconState::NORMAL; k <= IconState::PRESSED; k++)
+  {
+    // one throwaway scene per state, the shadow effect is only
+    // evaluated here and never during regular repaints
+    QGraphicsScene scene;
+
+    QPen pen = this->pen();
+    pen.setWidthF(k == IconState::PRESSED ? this->pen_width + 1.f : this->pen_width);
+
+    QGraphicsPathItem *item = new QGraphicsPathItem(this->path());
+    item->setPen(pen);
+    item->setOpacity(k == IconState::HOVERED ? ICON_HOVERED_OPACITY : 1.f);
+
+    auto effect = new QGraphicsDropShadowEffect;
+    effect->setOffset(ICON_SHADOW_OFFSET, ICON_SHADOW_OFFSET);
+    effect->setBlurRadius(ICON_SHADOW_BLUR_RADIUS);
+    effect->setColor(Qt::black);
+    item->setGraphicsEffect(effect);
+
+    scene.addItem(item); // owned by scene
+
+    QRectF target(QPointF(k * cell_size.width(), 0.f), QSizeF(cell_size));
+    scene.render(&painter, target, rect);
+  }
+
+  painter.end();
+
+  this->atlas = QPixmap::fromImage(image);
+  this->atlas_dpr = device_pixel_ratio;
+}
+
+void AbstractIcon::set_icon_path(const QPainterPath &new_path)
+{
+  this->setPath(new_path);
+  this->atlas = QPixmap(); // rebuilt on next paint
+}
+
+void AbstractIcon::set_state(IconState new_state)
+{
+  if (new_state == this->state)
+    return;
+
+  this->state = new_state;
+  this->update();
 }
 
 } // namespace gngui
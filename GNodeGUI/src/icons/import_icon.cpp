@@ -34,7 +34,7 @@ void ImportIcon::set_path()
   path.moveTo(lm - dx, lm + dx);
   path.lineTo(lm + dx, lm);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
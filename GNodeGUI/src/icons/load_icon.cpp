@@ -38,7 +38,7 @@ void LoadIcon::set_path()
   path.moveTo(dx, 2.f * dx);
   path.lineTo(this->width - dx, 2.f * dx);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
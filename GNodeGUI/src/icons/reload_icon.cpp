@@ -47,7 +47,7 @@ void ReloadIcon::set_path()
   path.addPath(arrow_head);
 
   // set the constructed path
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
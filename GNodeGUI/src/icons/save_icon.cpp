@@ -38,7 +38,7 @@ void SaveIcon::set_path()
   path.moveTo(dx, this->width - dx);
   path.lineTo(this->width - dx, this->width - dx);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
@@ -29,7 +29,7 @@ void SelectAllIcon::set_path()
   QRectF rect(0.f, 0.f, this->width, this->width);
   path.addRoundedRect(rect, 0.2f * this->width, 0.2f * this->width);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
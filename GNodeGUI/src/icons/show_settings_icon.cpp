@@ -37,7 +37,7 @@ void ShowSettingsIcon::set_path()
                 height);
   path.addRoundedRect(rect, 0.5f * height, 0.5f * height);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
@@ -63,7 +63,7 @@ void ViewportIcon::set_path()
   QRectF rect(0.f, 0.f, this->width, this->width);
   path.addRoundedRect(rect, 0.05f * this->width, 0.05f * this->width);
 
-  this->setPath(path);
+  this->set_icon_path(path);
 }
 
 } // namespace gngui
@@ -0,0 +1,257 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "gnodegui/node_telemetry.hpp"
+#include "gnodegui/style.hpp"
+
+namespace gngui
+{
+
+static std::string format_number(double value, const char *unit)
+{
+  char        buffer[32];
+  const char *fmt = value < 10.0 ? "%.1f %s" : "%.0f %s";
+
+  std::snprintf(buffer, sizeof(buffer), fmt, value, unit);
+  return buffer;
+}
+
+static std::string format_bytes(double bytes)
+{
+  const char *units[] = {"B", "kB", "MB", "GB", "TB"};
+  int         k = 0;
+
+  while (bytes >= 1024.0 && k < 4)
+  {
+    bytes /= 1024.0;
+    k++;
+  }
+
+  return format_number(bytes, units[k]);
+}
+
+static std::string format_duration(double ms)
+{
+  return ms < 1000.0 ? format_number(ms, "ms") : format_number(ms / 1000.0, "s");
+}
+
+// position of 'value' in [0, max_value], in [0, 1] on a log scale
+static float get_log_ratio(double value, double max_value)
+{
+  if (max_value <= 0.0)
+    return 0.f;
+
+  return std::clamp(float(std::log1p(value) / std::log1p(max_value)), 0.f, 1.f);
+}
+
+static QColor lerp_color(const QColor &c0, const QColor &c1, float t)
+{
+  return QColor::fromRgbF(c0.redF() + t * (c1.redF() - c0.redF()),
+                          c0.greenF() + t * (c1.greenF() - c0.greenF()),
+                          c0.blueF() + t * (c1.blueF() - c0.blueF()),
+                          c0.alphaF() + t * (c1.alphaF() - c0.alphaF()));
+}
+
+// --- DataflowOverlay
+
+QColor DataflowOverlay::get_color(double value) const
+{
+  return lerp_color(GN_STYLE->link.color_dataflow_low,
+                    GN_STYLE->link.color_dataflow_high,
+                    get_log_ratio(value, this->max_color_value));
+}
+
+float DataflowOverlay::get_width(double value) const
+{
+  const float t = get_log_ratio(value, this->max_width_value);
+
+  return GN_STYLE->link.pen_width +
+         t * (GN_STYLE->link.pen_width_dataflow_max - GN_STYLE->link.pen_width);
+}
+
+// --- LinkTelemetry
+
+std::string LinkTelemetry::format(LinkMetric metric) const
+{
+  switch (metric)
+  {
+  case LinkMetric::BYTES:
+    return format_bytes((double)this->bytes);
+
+  case LinkMetric::TRANSFER_RATE:
+    return format_number(this->transfer_rate, "/s");
+
+  case LinkMetric::CACHE_HITS:
+    return std::to_string(this->cache_hits);
+
+  case LinkMetric::CACHE_MISSES:
+    return std::to_string(this->cache_misses);
+  }
+
+  return std::string();
+}
+
+double LinkTelemetry::get(LinkMetric metric) const
+{
+  switch (metric)
+  {
+  case LinkMetric::BYTES:
+    return (double)this->bytes;
+
+  case LinkMetric::TRANSFER_RATE:
+    return this->transfer_rate;
+
+  case LinkMetric::CACHE_HITS:
+    return (double)this->cache_hits;
+
+  case LinkMetric::CACHE_MISSES:
+    return (double)this->cache_misses;
+  }
+
+  return 0.0;
+}
+
+void LinkTelemetry::set(LinkMetric metric, double value)
+{
+  value = std::max(0.0, value);
+
+  switch (metric)
+  {
+  case LinkMetric::BYTES:
+    this->bytes = (uint64_t)value;
+    break;
+
+  case LinkMetric::TRANSFER_RATE:
+    this->transfer_rate = value;
+    break;
+
+  case LinkMetric::CACHE_HITS:
+    this->cache_hits = (uint32_t)value;
+    break;
+
+  case LinkMetric::CACHE_MISSES:
+    this->cache_misses = (uint32_t)value;
+    break;
+  }
+}
+
+// --- NodeTelemetry
+
+std::string NodeTelemetry::format(TelemetryMetric metric) const
+{
+  switch (metric)
+  {
+  case TelemetryMetric::DURATION:
+    return format_duration(this->duration);
+
+  case TelemetryMetric::TOTAL_DURATION:
+    return format_duration(this->total_duration);
+
+  case TelemetryMetric::COMPUTE_COUNT:
+    return "x" + std::to_string(this->compute_count);
+
+  case TelemetryMetric::PEAK_MEMORY:
+    return format_bytes((double)this->peak_memory);
+
+  case TelemetryMetric::OUTPUT_SIZE:
+    return format_bytes((double)this->output_size);
+  }
+
+  return std::string();
+}
+
+double NodeTelemetry::get(TelemetryMetric metric) const
+{
+  switch (metric)
+  {
+  case TelemetryMetric::DURATION:
+    return this->duration;
+
+  case TelemetryMetric::TOTAL_DURATION:
+    return this->total_duration;
+
+  case TelemetryMetric::COMPUTE_COUNT:
+    return (double)this->compute_count;
+
+  case TelemetryMetric::PEAK_MEMORY:
+    return (double)this->peak_memory;
+
+  case TelemetryMetric::OUTPUT_SIZE:
+    return (double)this->output_size;
+  }
+
+  return 0.0;
+}
+
+void NodeTelemetry::set(TelemetryMetric metric, double value)
+{
+  value = std::max(0.0, value);
+
+  switch (metric)
+  {
+  case TelemetryMetric::DURATION:
+    this->duration = value;
+    break;
+
+  case TelemetryMetric::TOTAL_DURATION:
+    this->total_duration = value;
+    break;
+
+  case TelemetryMetric::COMPUTE_COUNT:
+    this->compute_count = (uint32_t)value;
+    break;
+
+  case TelemetryMetric::PEAK_MEMORY:
+    this->peak_memory = (uint64_t)value;
+    break;
+
+  case TelemetryMetric::OUTPUT_SIZE:
+    this->output_size = (uint64_t)value;
+    break;
+  }
+}
+
+// --- TelemetryOverlay
+
+QColor TelemetryOverlay::get_color(double value) const
+{
+  return lerp_color(GN_STYLE->node.color_heatmap_cold,
+                    GN_STYLE->node.color_heatmap_hot,
+                    get_log_ratio(value, this->max_value));
+}
+
+// --- helper
+
+std::string get_link_metric_caption(LinkMetric metric)
+{
+  switch (metric)
+  {
+  case LinkMetric::BYTES:
+    return "Data volume";
+
+  case LinkMetric::TRANSFER_RATE:
+    return "Transfer rate";
+
+  case LinkMetric::CACHE_HITS:
+    return "Cache hits";
+
+  case LinkMetric::CACHE_MISSES:
+    return "Cache misses";
+  }
+
+  return std::string();
+}
+
+int64_t get_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace gngui
@@ -0,0 +1,168 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "gnodegui/logger.hpp"
+#include "gnodegui/png_stream_writer.hpp"
+
+// size of the IDAT chunks, compressed data
+#define IDAT_CHUNK_SIZE 65536
+
+namespace gngui
+{
+
+static void push_u32(std::vector<uint8_t> &data, uint32_t value)
+{
+  // PNG integers are big-endian
+  data.push_back((value >> 24) & 0xff);
+  data.push_back((value >> 16) & 0xff);
+  data.push_back((value >> 8) & 0xff);
+  data.push_back(value & 0xff);
+}
+
+PngStreamWriter::PngStreamWriter(const std::string &fname, int width, int height)
+    : file(fname, std::ios::binary), width(width), height(height)
+{
+  if (!this->file.is_open())
+  {
+    Logger::log()->error("PngStreamWriter: failed to open file: {}", fname);
+    return;
+  }
+
+  this->p_stream = std::make_unique<z_stream_s>();
+
+  if (deflateInit(this->p_stream.get(), Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    Logger::log()->error("PngStreamWriter: failed to initialize zlib");
+    this->p_stream.reset();
+    this->file.setstate(std::ios::failbit);
+    return;
+  }
+
+  this->out_buffer.resize(IDAT_CHUNK_SIZE);
+  this->p_stream->next_out = this->out_buffer.data();
+  this->p_stream->avail_out = IDAT_CHUNK_SIZE;
+
+  const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  this->file.write(reinterpret_cast<const char *>(signature), 8);
+
+  // 8-bit RGBA, no interlacing
+  std::vector<uint8_t> header;
+  push_u32(header, (uint32_t)width);
+  push_u32(header, (uint32_t)height);
+  header.insert(header.end(), {8, 6, 0, 0, 0});
+  this->write_chunk("IHDR", header.data(), header.size());
+}
+
+PngStreamWriter::~PngStreamWriter()
+{
+  if (!this->is_closed)
+    this->close();
+}
+
+bool PngStreamWriter::close()
+{
+  if (this->is_closed)
+    return this->is_valid();
+
+  // nothing can be written without the file or the deflate stream
+  if (!this->file.is_open() || !this->p_stream)
+  {
+    this->is_closed = true;
+    return false;
+  }
+
+  // missing rows, if any, are left transparent
+  if (this->rows_written < this->height)
+  {
+    QImage blank(this->width, 1, QImage::Format_RGBA8888);
+    blank.fill(Qt::transparent);
+
+    while (this->rows_written < this->height)
+      this->write_rows(blank, 1);
+  }
+
+  this->is_closed = true;
+
+  // remaining compressed data and zlib trailer
+  this->compress(nullptr, 0, Z_FINISH);
+  deflateEnd(this->p_stream.get());
+  this->p_stream.reset();
+
+  this->write_chunk("IEND", nullptr, 0);
+
+  this->file.close();
+  return !this->file.fail();
+}
+
+void PngStreamWriter::compress(const uint8_t *data, size_t size, int flush)
+{
+  z_stream_s &stream = *this->p_stream;
+
+  stream.next_in = const_cast<uint8_t *>(data);
+  stream.avail_in = (uInt)size;
+
+  while (true)
+  {
+    const int ret = deflate(&stream, flush);
+
+    // output buffer full, or stream finished: flushed to a chunk
+    const bool is_done = flush == Z_FINISH ? ret == Z_STREAM_END : stream.avail_in == 0;
+
+    if (stream.avail_out == 0 || (is_done && flush == Z_FINISH))
+    {
+      this->write_chunk("IDAT",
+                        this->out_buffer.data(),
+                        IDAT_CHUNK_SIZE - stream.avail_out);
+      stream.next_out = this->out_buffer.data();
+      stream.avail_out = IDAT_CHUNK_SIZE;
+    }
+
+    if (is_done || ret == Z_STREAM_ERROR)
+      break;
+  }
+}
+
+void PngStreamWriter::write_chunk(const char *type, const uint8_t *data, size_t size)
+{
+  std::vector<uint8_t> bytes;
+  bytes.reserve(size + 12);
+
+  push_u32(bytes, (uint32_t)size);
+  bytes.insert(bytes.end(), type, type + 4);
+  if (size)
+    bytes.insert(bytes.end(), data, data + size);
+
+  // the checksum covers the chunk type and data
+  push_u32(bytes, (uint32_t)crc32(0L, bytes.data() + 4, (uInt)(size + 4)));
+
+  this->file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+void PngStreamWriter::write_rows(const QImage &image, int nrows)
+{
+  if (!this->p_stream || this->is_closed || image.width() != this->width)
+    return;
+
+  nrows = std::min({nrows, image.height(), this->height - this->rows_written});
+
+  const QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+  const size_t row_size = 1 + 4 * (size_t)this->width; // filter byte + pixels
+
+  std::vector<uint8_t> raw(row_size);
+
+  for (int j = 0; j < nrows; j++)
+  {
+    raw[0] = 0; // no filter
+    std::copy_n(rgba.constScanLine(j), row_size - 1, raw.begin() + 1);
+
+    this->compress(raw.data(), row_size, Z_NO_FLUSH);
+  }
+
+  this->rows_written += nrows;
+}
+
+} // namespace gngui
@@ -0,0 +1,44 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include "gnodegui/stats.hpp"
+
+namespace gngui
+{
+
+RuntimeCounters *RuntimeCounters::get()
+{
+  static RuntimeCounters counters;
+  return &counters;
+}
+
+nlohmann::json ViewerStats::json_to() const
+{
+  nlohmann::json json;
+
+  json["nodes"] = this->nodes;
+  json["links"] = this->links;
+  json["groups"] = this->groups;
+  json["comments"] = this->comments;
+  json["node_records"] = this->node_records;
+  json["link_records"] = this->link_records;
+
+  json["frame_time"] = this->frame_time;
+  json["frame_count"] = this->frame_count;
+  json["node_paints"] = this->node_paints;
+  json["link_paints"] = this->link_paints;
+  json["group_paints"] = this->group_paints;
+  json["comment_paints"] = this->comment_paints;
+
+  json["link_path_rebuilds"] = this->link_path_rebuilds;
+  json["geometry_computations"] = this->geometry_computations;
+  json["scene_scans"] = this->scene_scans;
+  json["signal_emissions"] = this->signal_emissions;
+
+  json["geometry_cache_hit_rate"] = this->geometry_cache_hit_rate;
+  json["thumbnail_cache_hit_rate"] = this->thumbnail_cache_hit_rate;
+
+  return json;
+}
+
+} // namespace gngui
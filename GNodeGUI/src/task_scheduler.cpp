@@ -0,0 +1,244 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <algorithm>
+
+#include "gnodegui/logger.hpp"
+#include "gnodegui/task_scheduler.hpp"
+
+namespace gngui
+{
+
+// index of the worker running on this thread, -1 outside of the workers
+static thread_local int current_worker_index = -1;
+
+TaskScheduler *TaskScheduler::get()
+{
+  static TaskScheduler scheduler;
+  return &scheduler;
+}
+
+TaskScheduler::~TaskScheduler() { this->stop(); }
+
+int TaskScheduler::get_thread_count() const
+{
+  if (this->thread_count > 0)
+    return this->thread_count;
+
+  return std::max(1, (int)std::thread::hardware_concurrency() - 1);
+}
+
+void TaskScheduler::parallel_for(size_t                                     begin,
+                                 size_t                                     end,
+                                 const std::function<void(size_t, size_t)> &fct,
+                                 size_t                                     grain)
+{
+  if (end <= begin)
+    return;
+
+  grain = std::max(grain, size_t(1));
+
+  const size_t nranges = (end - begin + grain - 1) / grain;
+  const size_t nhelpers = std::min(nranges - 1, (size_t)this->get_thread_count());
+
+  if (nhelpers == 0)
+  {
+    fct(begin, end);
+    return;
+  }
+
+  // ranges taken by whoever is free first, the helpers starting after the last range
+  // is taken do nothing (the state outlives this call for them)
+  struct State
+  {
+    std::atomic<size_t>     next_range = 0;
+    std::atomic<size_t>     done_ranges = 0;
+    std::mutex              mutex;
+    std::condition_variable condition;
+  };
+
+  auto p_state = std::make_shared<State>();
+
+  auto run_ranges = [p_state, begin, end, grain, nranges, &fct]()
+  {
+    size_t count = 0;
+
+    for (size_t k = p_state->next_range++; k < nranges; k = p_state->next_range++)
+    {
+      fct(begin + k * grain, std::min(end, begin + (k + 1) * grain));
+      count++;
+    }
+
+    if (count > 0 && p_state->done_ranges.fetch_add(count) + count == nranges)
+    {
+      std::lock_guard<std::mutex> lock(p_state->mutex);
+      p_state->condition.notify_all();
+    }
+  };
+
+  for (size_t k = 0; k < nhelpers; k++)
+    this->submit(run_ranges);
+
+  run_ranges();
+
+  std::unique_lock<std::mutex> lock(p_state->mutex);
+  p_state->condition.wait(lock, [&]() { return p_state->done_ranges == nranges; });
+}
+
+bool TaskScheduler::pop_task(size_t worker_index, Task &task)
+{
+  const size_t nworkers = this->workers.size();
+
+  for (size_t k = 0; k < nworkers; k++)
+  {
+    Worker                     &worker = *this->workers[(worker_index + k) % nworkers];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.tasks.empty())
+      continue;
+
+    if (k == 0)
+    {
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    }
+    else
+    {
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+
+    this->pending--;
+    return true;
+  }
+
+  return false;
+}
+
+void TaskScheduler::push_task(size_t worker_index, Task task)
+{
+  std::lock_guard<std::mutex> lock(this->workers[worker_index]->mutex);
+  this->workers[worker_index]->tasks.push_back(std::move(task));
+  this->pending++;
+}
+
+void TaskScheduler::run_worker(size_t worker_index)
+{
+  current_worker_index = (int)worker_index;
+
+  while (true)
+  {
+    Task task;
+
+    if (this->pop_task(worker_index, task))
+    {
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(this->wake_mutex);
+    this->wake_condition.wait(
+        lock,
+        [this]() { return this->is_stopping || this->pending > 0; });
+
+    // queued tasks are still run when stopping
+    if (this->is_stopping && this->pending == 0)
+      return;
+  }
+}
+
+void TaskScheduler::set_executor(TaskExecutor new_executor)
+{
+  std::lock_guard<std::mutex> lock(this->settings_mutex);
+
+  this->stop();
+  this->executor = std::move(new_executor);
+
+  Logger::log()->trace("TaskScheduler::set_executor: {}",
+                       this->executor ? "host executor" : "own workers");
+}
+
+void TaskScheduler::set_thread_count(int new_thread_count)
+{
+  std::lock_guard<std::mutex> lock(this->settings_mutex);
+
+  this->stop();
+  this->thread_count = std::max(0, new_thread_count);
+
+  Logger::log()->trace("TaskScheduler::set_thread_count: {}", this->get_thread_count());
+}
+
+void TaskScheduler::start()
+{
+  if (!this->threads.empty())
+    return;
+
+  const int nthreads = this->get_thread_count();
+
+  this->is_stopping = false;
+  this->workers.clear();
+
+  for (int k = 0; k < nthreads; k++)
+    this->workers.push_back(std::make_unique<Worker>());
+
+  for (int k = 0; k < nthreads; k++)
+    this->threads.emplace_back([this, k]() { this->run_worker((size_t)k); });
+}
+
+void TaskScheduler::stop()
+{
+  if (this->threads.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->wake_mutex);
+    this->is_stopping = true;
+  }
+
+  this->wake_condition.notify_all();
+
+  for (std::thread &thread : this->threads)
+    thread.join();
+
+  this->threads.clear();
+  this->workers.clear();
+}
+
+void TaskScheduler::submit(Task task)
+{
+  if (current_worker_index >= 0)
+  {
+    // from a worker (the workers are running, no executor): own queue, most recent
+    // first for cache locality. No settings lock, a stop may be waiting for this
+    // worker
+    this->push_task((size_t)current_worker_index, std::move(task));
+  }
+  else
+  {
+    std::unique_lock<std::mutex> lock(this->settings_mutex);
+
+    if (this->executor)
+    {
+      // run unlocked, the host may submit from there
+      TaskExecutor host_executor = this->executor;
+      lock.unlock();
+
+      host_executor(std::move(task));
+      return;
+    }
+
+    // held until the task is queued, 'set_thread_count' and 'set_executor' rebuild
+    // the workers under this lock
+    this->start(); // on first use, not on library load
+    this->push_task(this->next_worker++ % this->workers.size(), std::move(task));
+  }
+
+  // a worker checking 'pending' right now is waiting once the lock is taken
+  {
+    std::lock_guard<std::mutex> lock(this->wake_mutex);
+  }
+
+  this->wake_condition.notify_one();
+}
+
+} // namespace gngui
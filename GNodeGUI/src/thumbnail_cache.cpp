@@ -0,0 +1,242 @@
+/* Copyright (c) 2024 Otto Link. Distributed under the terms of the GNU General
+ * Public License. The full license is in the file LICENSE, distributed with
+ * this software. */
+#include <QMetaObject>
+
+#include "gnodegui/logger.hpp"
+#include "gnodegui/task_scheduler.hpp"
+#include "gnodegui/thumbnail_cache.hpp"
+
+#define THUMBNAIL_RETRY_DELAY 2000 // ms
+
+namespace gngui
+{
+
+ThumbnailCache::ThumbnailCache(QObject *parent) : QObject(parent)
+{
+  this->delivery = std::make_shared<Delivery>();
+  this->delivery->p_cache = this;
+  this->clock.start();
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+  // jobs not started yet are skipped, the running ones are not waited for and
+  // their result is dropped
+  this->cancel_pending([](const Key &) { return true; });
+
+  std::lock_guard<std::mutex> lock(this->delivery->mutex);
+  this->delivery->p_cache = nullptr;
+}
+
+void ThumbnailCache::cancel_pending(const std::function<bool(const Key &)> &predicate)
+{
+  for (auto it = this->pending.begin(); it != this->pending.end();)
+  {
+    if (predicate(it->first.first))
+    {
+      *it->second.is_cancelled = true;
+      it = this->pending.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+void ThumbnailCache::clear()
+{
+  this->entries.clear();
+  this->lru.clear();
+  this->cancel_pending([](const Key &) { return true; });
+  this->skipped_versions.clear();
+  this->evicted_versions.clear();
+  this->memory_usage = 0;
+}
+
+void ThumbnailCache::evict(bool keep_most_recent)
+{
+  const size_t min_count = keep_most_recent ? 1 : 0;
+
+  while (this->memory_usage > this->memory_budget && this->lru.size() > min_count)
+  {
+    auto it = this->entries.find(this->lru.back());
+    this->evicted_versions[it->first] = {it->second.version, this->clock.elapsed()};
+    this->memory_usage -= it->second.image.sizeInBytes();
+    this->entries.erase(it);
+    this->lru.pop_back();
+  }
+}
+
+const QImage *ThumbnailCache::get(const std::string &node_id,
+                                  int                port_index,
+                                  uint64_t           version,
+                                  const std::string &data_type,
+                                  void              *p_data,
+                                  QSize              size)
+{
+  const Key key = {node_id, port_index};
+  auto      it = this->entries.find(key);
+
+  const bool is_up_to_date = it != this->entries.end() && it->second.version == version;
+
+  if (is_up_to_date)
+    this->hit_count++;
+  else
+    this->miss_count++;
+
+  // schedule a conversion, once per key and version. The data is read here, on the
+  // GUI thread, the worker only gets the converter copy of it
+  if (!is_up_to_date && p_data && this->has_converter(data_type) &&
+      !this->pending.contains({key, version}) && !this->is_skipped(key, version))
+  {
+    ThumbnailJob job = this->converters.at(data_type)(p_data, size);
+
+    if (!job)
+    {
+      // nothing to show for this version, do not ask the converter again
+      this->skipped_versions[key] = version;
+    }
+    else
+    {
+      const uint64_t ticket = this->next_ticket++;
+      auto           is_cancelled = std::make_shared<std::atomic<bool>>(false);
+
+      this->pending[{key, version}] = Request{ticket, is_cancelled};
+
+      GN_SCHEDULER->submit(
+          [delivery = this->delivery, job, key, version, ticket, is_cancelled]()
+          {
+            if (*is_cancelled)
+              return;
+
+            QImage image = job();
+
+            // only posted, the lock is not held for long
+            std::lock_guard<std::mutex> lock(delivery->mutex);
+            ThumbnailCache             *p_cache = delivery->p_cache;
+
+            if (*is_cancelled || !p_cache)
+              return;
+
+            QMetaObject::invokeMethod(
+                p_cache,
+                [p_cache, key, version, ticket, image]()
+                { p_cache->insert(key, version, ticket, image); },
+                Qt::QueuedConnection);
+          });
+    }
+  }
+
+  if (it == this->entries.end())
+    return nullptr;
+
+  // mark as most recently used
+  this->lru.splice(this->lru.begin(), this->lru, it->second.lru_it);
+
+  return &it->second.image;
+}
+
+bool ThumbnailCache::has_converter(const std::string &data_type) const
+{
+  return this->converters.contains(data_type);
+}
+
+bool ThumbnailCache::is_skipped(const Key &key, uint64_t version) const
+{
+  auto skipped_it = this->skipped_versions.find(key);
+
+  if (skipped_it != this->skipped_versions.end() && skipped_it->second == version)
+    return true;
+
+  // an evicted version is only converted again after a while, otherwise thumbnails
+  // competing for a too small budget would be converted in a loop
+  auto evicted_it = this->evicted_versions.find(key);
+
+  return evicted_it != this->evicted_versions.end() &&
+         evicted_it->second.first == version &&
+         this->clock.elapsed() - evicted_it->second.second < THUMBNAIL_RETRY_DELAY;
+}
+
+void ThumbnailCache::insert(const Key    &key,
+                            uint64_t      version,
+                            uint64_t      ticket,
+                            const QImage &image)
+{
+  // the request may have been cancelled by a clear / node removal, and possibly
+  // issued again since then
+  auto request_it = this->pending.find({key, version});
+
+  if (request_it == this->pending.end() || request_it->second.ticket != ticket)
+    return;
+
+  this->pending.erase(request_it);
+
+  auto it = this->entries.find(key);
+
+  // a newer version may have landed first
+  if (it != this->entries.end() && it->second.version > version)
+    return;
+
+  // would be evicted right away and requested again on the next paint
+  if (static_cast<size_t>(image.sizeInBytes()) > this->memory_budget)
+  {
+    Logger::log()->trace("ThumbnailCache::insert: thumbnail over the memory budget");
+    this->skipped_versions[key] = version;
+    return;
+  }
+
+  if (it != this->entries.end())
+  {
+    this->memory_usage -= it->second.image.sizeInBytes();
+    it->second.version = version;
+    it->second.image = image;
+    this->lru.splice(this->lru.begin(), this->lru, it->second.lru_it);
+  }
+  else
+  {
+    this->lru.push_front(key);
+    this->entries[key] = Entry{version, image, this->lru.begin()};
+  }
+
+  this->memory_usage += image.sizeInBytes();
+  this->evict(true);
+
+  Q_EMIT this->thumbnail_ready(key.first, key.second);
+}
+
+void ThumbnailCache::remove_node(const std::string &node_id)
+{
+  for (auto it = this->entries.begin(); it != this->entries.end();)
+  {
+    if (it->first.first == node_id)
+    {
+      this->memory_usage -= it->second.image.sizeInBytes();
+      this->lru.erase(it->second.lru_it);
+      it = this->entries.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  std::erase_if(this->skipped_versions,
+                [&node_id](const auto &item) { return item.first.first == node_id; });
+  std::erase_if(this->evicted_versions,
+                [&node_id](const auto &item) { return item.first.first == node_id; });
+
+  this->cancel_pending([&node_id](const Key &key) { return key.first == node_id; });
+}
+
+void ThumbnailCache::set_converter(const std::string &data_type,
+                                   ThumbnailConverter converter)
+{
+  Logger::log()->trace("ThumbnailCache::set_converter: data type {}", data_type);
+  this->converters[data_type] = converter;
+}
+
+void ThumbnailCache::set_memory_budget(size_t new_memory_budget)
+{
+  this->memory_budget = new_memory_budget;
+  this->evict(false);
+}
+
+} // namespace gngui
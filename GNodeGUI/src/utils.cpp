@@ -11,9 +11,14 @@
 #include <QRectF>
 #include <QTimer>
 
+#include "gnodegui/graph_viewer.hpp"
 #include "gnodegui/graphics_link.hpp"
 #include "gnodegui/graphics_node.hpp"
 #include "gnodegui/logger.hpp"
+#include "gnodegui/stats.hpp"
+
+// item data key holding the view an overlay item belongs to
+#define OVERLAY_VIEW_KEY 0x676e
 
 namespace gngui
 {
@@ -55,6 +60,48 @@ QRectF compute_bounding_rect(const std::vector<QGraphicsItem *> &items)
   return bounding_rect;
 }
 
+QList<QGraphicsItem *> get_scene_items(const QGraphicsScene *scene)
+{
+  if (!scene)
+    return {};
+
+  GN_COUNTERS->scene_scans++;
+  return scene->items();
+}
+
+bool is_draft_render(const QWidget *widget)
+{
+  // 'widget' is the viewport of the view being painted, none for exports and
+  // other offscreen renderings which are always full quality. Items skip their
+  // most expensive drawing steps while that view is being navigated
+  if (!widget)
+    return false;
+
+  const GraphViewer *p_viewer = qobject_cast<const GraphViewer *>(widget->parent());
+  return p_viewer && p_viewer->is_draft_rendering();
+}
+
+bool is_overlay_drawn_in(const QGraphicsItem *item, const QWidget *widget)
+{
+  // 'widget' is the viewport of the view being painted (or receiving
+  // the event), its parent is the view itself
+  if (!is_overlay_item(item) || !widget)
+    return true;
+
+  const quintptr view = item->data(OVERLAY_VIEW_KEY).value<quintptr>();
+  return view == reinterpret_cast<quintptr>(widget->parentWidget());
+}
+
+bool is_overlay_item(const QGraphicsItem *item)
+{
+  return item && item->data(OVERLAY_VIEW_KEY).isValid();
+}
+
+void set_overlay_view(QGraphicsItem *item, const QGraphicsView *view)
+{
+  item->setData(OVERLAY_VIEW_KEY, QVariant::fromValue(reinterpret_cast<quintptr>(view)));
+}
+
 std::vector<std::string> split_string(const std::string &string, char delimiter)
 {
   std::vector<std::string> result;
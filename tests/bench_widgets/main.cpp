@@ -0,0 +1,210 @@
+/* Node widgets benchmark: memory and frame time of a graph made of nodes embedding a
+ * widget, with and without widget virtualization.
+ *
+ * usage: bench_widgets [--no-virtualization] [nnodes] (use '-platform offscreen' on
+ * headless machines)
+ */
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include <QVBoxLayout>
+#include <QWheelEvent>
+
+#include "gnodegui/graph_viewer.hpp"
+#include "gnodegui/graphics_node.hpp"
+#include "gnodegui/logger.hpp"
+#include "gnodegui/node_proxy.hpp"
+#include "gnodegui/style.hpp"
+
+// --- node specialization
+
+class BenchNode
+{
+public:
+  BenchNode(std::string id) : id(id) {}
+
+  std::string get_caption() const { return "Preview"; }
+  std::string get_category() const { return "Debug"; }
+  std::string get_comment() const { return ""; }
+  void       *get_data_ref(int /*port_index*/) const { return nullptr; }
+  std::string get_data_type(int /*port_index*/) const { return "float"; }
+  std::string get_id() const { return this->id; }
+  int         get_nports() const { return 2; }
+
+  std::string get_port_caption(int port_index) const
+  {
+    return port_index == 0 ? "in" : "out";
+  }
+
+  gngui::PortType get_port_type(int port_index) const
+  {
+    return port_index == 0 ? gngui::PortType::IN : gngui::PortType::OUT;
+  }
+
+  std::string get_tool_tip_text() const { return ""; }
+  void        set_id(const std::string &new_id) { this->id = new_id; }
+
+private:
+  std::string id;
+};
+
+QWidget *create_widget()
+{
+  QWidget     *widget = new QWidget();
+  QVBoxLayout *layout = new QVBoxLayout(widget);
+  layout->addWidget(new QLabel("preview"));
+  layout->addWidget(new QSlider(Qt::Horizontal));
+  layout->addWidget(new QPushButton("button"));
+  return widget;
+}
+
+// --- helpers
+
+long get_rss_kb()
+{
+  // Linux only, -1 elsewhere
+  std::ifstream file("/proc/self/status");
+  std::string   key;
+
+  while (file >> key)
+  {
+    if (key == "VmRSS:")
+    {
+      long value;
+      file >> value;
+      return value;
+    }
+    file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+
+  return -1;
+}
+
+void process_events_for(int ms)
+{
+  QElapsedTimer timer;
+  timer.start();
+  while (timer.elapsed() < ms)
+    QCoreApplication::processEvents();
+}
+
+double measure_frame_time_ms(gngui::GraphViewer &viewer, int nframes)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int k = 0; k < nframes; k++)
+    viewer.viewport()->repaint();
+
+  return (double)timer.nsecsElapsed() * 1e-6 / nframes;
+}
+
+int count_live_widgets(gngui::GraphViewer &viewer, const std::vector<std::string> &ids)
+{
+  int count = 0;
+  for (auto &id : ids)
+    if (viewer.get_graphics_node_by_id(id)->is_widget_live())
+      count++;
+  return count;
+}
+
+// --- application
+
+int main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  bool virtualize = true;
+  int  nnodes = 500;
+
+  for (int k = 1; k < argc; k++)
+  {
+    std::string arg = argv[k];
+    if (arg == "--no-virtualization")
+      virtualize = false;
+    else
+      nnodes = std::stoi(arg);
+  }
+
+  gngui::Logger::log()->set_level(spdlog::level::warn);
+  GN_STYLE->viewer.virtualize_widgets = virtualize;
+
+  // the close-up zoom loop below sends wheel events without running the event loop,
+  // they have to be applied right away instead of once per frame
+  GN_STYLE->viewer.coalesce_input = false;
+
+  const long rss_start = get_rss_kb();
+
+  gngui::GraphViewer viewer;
+  viewer.resize(1280, 800);
+  viewer.show();
+
+  std::vector<std::shared_ptr<BenchNode>> models;
+  std::vector<std::string>                ids;
+
+  const int   ncols = 25;
+  const QSize widget_size(128, 96);
+
+  for (int k = 0; k < nnodes; k++)
+  {
+    auto model = std::make_shared<BenchNode>("node" + std::to_string(k));
+    auto proxy = new gngui::TypedNodeProxy<BenchNode>(model);
+    models.push_back(model);
+
+    QPointF     pos(300.f * (k % ncols), 300.f * (k / ncols));
+    std::string id = viewer.add_node(proxy, pos, model->get_id());
+    ids.push_back(id);
+
+    gngui::GraphicsNode *p_node = viewer.get_graphics_node_by_id(id);
+
+    if (virtualize)
+      p_node->set_widget_factory(&create_widget, widget_size);
+    else
+      p_node->set_widget(create_widget(), widget_size);
+  }
+
+  // overview: whole graph in view
+  viewer.zoom_to_content();
+  process_events_for(100);
+
+  const double overview_ms = measure_frame_time_ms(viewer, 50);
+  const int    overview_live = count_live_widgets(viewer, ids);
+
+  // close-up: zoom in on the center of the viewport like a user would
+  QPointF center = QPointF(viewer.viewport()->rect().center());
+
+  while (viewer.transform().m11() < 1.f)
+  {
+    QWheelEvent event(center,
+                      viewer.viewport()->mapToGlobal(center),
+                      QPoint(),
+                      QPoint(0, 120),
+                      Qt::NoButton,
+                      Qt::NoModifier,
+                      Qt::NoScrollPhase,
+                      false);
+    QApplication::sendEvent(viewer.viewport(), &event);
+  }
+  process_events_for(GN_STYLE->viewer.draft_idle_timeout + 100);
+
+  const double closeup_ms = measure_frame_time_ms(viewer, 50);
+  const int    closeup_live = count_live_widgets(viewer, ids);
+
+  const long rss_end = get_rss_kb();
+
+  std::cout << "nodes:               " << nnodes << "\n";
+  std::cout << "virtualization:      " << (virtualize ? "on" : "off") << "\n";
+  std::cout << "memory (RSS delta):  " << (rss_end - rss_start) / 1024.f << " MB\n";
+  std::cout << "overview frame time: " << overview_ms << " ms (" << overview_live
+            << " live widgets)\n";
+  std::cout << "close-up frame time: " << closeup_ms << " ms (" << closeup_live
+            << " live widgets)\n";
+
+  return 0;
+}